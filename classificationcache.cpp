@@ -0,0 +1,91 @@
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include "classificationcache.h"
+#include "stablehash.h"
+
+QString ClassificationCache::cacheFileName(const QString& circuitFile) {
+    if (circuitFile.isEmpty()) return QString();
+    return circuitFile + ".sigcache";
+}
+
+quint64 ClassificationCache::netFingerprint(const QList<SignalVisualizer::NetPinInfo>& pins) {
+    // Сумма не зависит от порядка пинов; номинал источника влияет на обозначение цепи
+    quint64 fingerprint = 0;
+    for (const SignalVisualizer::NetPinInfo& pin : pins) {
+        quint64 h = StableHash::string(pin.pinId);
+        h = StableHash::mix(h ^ (StableHash::string(pin.compType) * 31));
+        h = StableHash::mix(h ^ StableHash::number(pin.value));
+        fingerprint += h;
+    }
+    return fingerprint;
+}
+
+quint64 ClassificationCache::circuitFingerprint(const QHash<QString, quint64>& netFingerprints) {
+    quint64 fingerprint = quint64(netFingerprints.size());
+    for (quint64 net : netFingerprints) {
+        fingerprint += StableHash::mix(net);
+    }
+    return StableHash::mix(fingerprint);
+}
+
+bool ClassificationCache::load(const QString& fileName) {
+    m_entries.clear();
+    m_circuitFingerprint = 0;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint32 count = 0;
+    in >> magic >> version;
+    if (magic != Magic || version != Version) return false;
+
+    in >> m_circuitFingerprint >> count;
+    m_entries.reserve(int(count));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        quint64 key = 0;
+        SignalVisualizer::SignalAttributes attr;
+        in >> key >> attr.designation >> attr.designationColor >> attr.designationInfo
+           >> attr.type >> attr.typeColor >> attr.typeInfo;
+        m_entries.insert(key, attr);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        m_entries.clear();
+        m_circuitFingerprint = 0;
+        return false;
+    }
+    return true;
+}
+
+bool ClassificationCache::save(const QString& fileName) const {
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << Magic << Version << m_circuitFingerprint << quint32(m_entries.size());
+
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        const SignalVisualizer::SignalAttributes& attr = it.value();
+        out << it.key() << attr.designation << attr.designationColor << attr.designationInfo
+            << attr.type << attr.typeColor << attr.typeInfo;
+    }
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+bool ClassificationCache::lookup(quint64 netFingerprint, SignalVisualizer::SignalAttributes& attr) const {
+    auto it = m_entries.constFind(netFingerprint);
+    if (it == m_entries.cend()) return false;
+    attr = it.value();
+    return true;
+}
+
+void ClassificationCache::insert(quint64 netFingerprint, const SignalVisualizer::SignalAttributes& attr) {
+    m_entries.insert(netFingerprint, attr);
+}
@@ -0,0 +1,35 @@
+#ifndef CLASSIFICATIONCACHE_H
+#define CLASSIFICATIONCACHE_H
+
+#include <QHash>
+#include <QString>
+#include "signalvisualizer.h"
+
+// Результаты классификации цепей, сохраняемые рядом с файлом схемы.
+// Ключ записи - отпечаток цепи: идентификаторы пинов, типы компонентов и номиналы источников.
+class ClassificationCache {
+public:
+    static QString cacheFileName(const QString& circuitFile);
+
+    static quint64 netFingerprint(const QList<SignalVisualizer::NetPinInfo>& pins);
+    static quint64 circuitFingerprint(const QHash<QString, quint64>& netFingerprints);
+
+    bool load(const QString& fileName);
+    bool save(const QString& fileName) const;
+
+    quint64 circuitFingerprint() const { return m_circuitFingerprint; }
+    void setCircuitFingerprint(quint64 fingerprint) { m_circuitFingerprint = fingerprint; }
+
+    bool lookup(quint64 netFingerprint, SignalVisualizer::SignalAttributes& attr) const;
+    void insert(quint64 netFingerprint, const SignalVisualizer::SignalAttributes& attr);
+    int size() const { return m_entries.size(); }
+
+private:
+    static const quint32 Magic = 0x53564343; // "SVCC"
+    static const quint16 Version = 1;
+
+    quint64 m_circuitFingerprint = 0;
+    QHash<quint64, SignalVisualizer::SignalAttributes> m_entries;
+};
+
+#endif // CLASSIFICATIONCACHE_H
@@ -0,0 +1,344 @@
+#include <QtEndian>
+#include <QXmlStreamReader>
+#include "colorschemebinary.h"
+#include "compresseddevice.h"
+
+namespace {
+    const int HeaderSize = 32;
+    const int NetRecordSize = 48;
+    const int StringEntrySize = 8;
+
+    // Смещения полей записи сети
+    enum NetField {
+        FieldFingerprint = 0,
+        FieldName = 8,
+        FieldDesignation = 12,
+        FieldDesignationInfo = 16,
+        FieldType = 20,
+        FieldTypeInfo = 24,
+        FieldDesignationColor = 28,
+        FieldTypeColor = 32,
+        FieldLineWidth = 36,
+        FieldPinFirst = 40,
+        FieldPinCount = 44
+    };
+
+    class StringTable {
+    public:
+        quint32 intern(const QString& value) {
+            auto it = m_index.constFind(value);
+            if (it != m_index.cend()) return it.value();
+
+            quint32 index = quint32(m_strings.size());
+            m_index.insert(value, index);
+            m_strings.append(value);
+            return index;
+        }
+
+        const QList<QString>& strings() const { return m_strings; }
+
+    private:
+        QHash<QString, quint32> m_index;
+        QList<QString> m_strings;
+    };
+
+    void putU16(QByteArray& data, int offset, quint16 value) {
+        qToLittleEndian<quint16>(value, data.data() + offset);
+    }
+
+    void putU32(QByteArray& data, int offset, quint32 value) {
+        qToLittleEndian<quint32>(value, data.data() + offset);
+    }
+
+    void putU64(QByteArray& data, int offset, quint64 value) {
+        qToLittleEndian<quint64>(value, data.data() + offset);
+    }
+
+    quint32 colorValue(const QColor& color) {
+        // Ноль означает отсутствие цвета
+        return color.isValid() ? quint32(color.rgba()) : 0;
+    }
+}
+
+const char ColorSchemeBinary::Magic[4] = {'C', 'S', 'C', 'B'};
+
+bool ColorSchemeBinary::isBinary(const QByteArray& header) {
+    return header.size() >= 4 && memcmp(header.constData(), Magic, 4) == 0;
+}
+
+bool ColorSchemeBinary::isBinaryFile(QIODevice* device) {
+    return device && isBinary(device->peek(4));
+}
+
+bool ColorSchemeBinary::write(QIODevice* device, const QList<SignalVisualizer::ConfigNet>& nets) {
+    StringTable strings;
+    QByteArray netTable(nets.size() * NetRecordSize, '\0');
+    QVector<quint32> pinIndex;
+
+    for (int i = 0; i < nets.size(); ++i) {
+        const SignalVisualizer::ConfigNet& net = nets[i];
+        const int record = i * NetRecordSize;
+
+        // Пины сортируются, чтобы одинаковые схемы давали одинаковые файлы
+        QStringList pinIds = net.pinIds.values();
+        pinIds.sort();
+
+        putU64(netTable, record + FieldFingerprint, net.fingerprint);
+        putU32(netTable, record + FieldName, strings.intern(net.name));
+        putU32(netTable, record + FieldDesignation, strings.intern(net.attributes.designation));
+        putU32(netTable, record + FieldDesignationInfo, strings.intern(net.attributes.designationInfo));
+        putU32(netTable, record + FieldType, strings.intern(net.attributes.type));
+        putU32(netTable, record + FieldTypeInfo, strings.intern(net.attributes.typeInfo));
+        putU32(netTable, record + FieldDesignationColor, colorValue(net.attributes.designationColor));
+        putU32(netTable, record + FieldTypeColor, colorValue(net.attributes.typeColor));
+        putU32(netTable, record + FieldLineWidth, quint32(qMax(0, net.lineWidth)));
+        putU32(netTable, record + FieldPinFirst, quint32(pinIndex.size()));
+        putU32(netTable, record + FieldPinCount, quint32(pinIds.size()));
+
+        for (const QString& pinId : pinIds) {
+            pinIndex.append(strings.intern(pinId));
+        }
+    }
+
+    QByteArray pinTable(pinIndex.size() * 4, '\0');
+    for (int i = 0; i < pinIndex.size(); ++i) {
+        putU32(pinTable, i * 4, pinIndex[i]);
+    }
+
+    const QList<QString>& stringList = strings.strings();
+    QByteArray stringTable(stringList.size() * StringEntrySize, '\0');
+    QByteArray stringData;
+    for (int i = 0; i < stringList.size(); ++i) {
+        const QString& value = stringList[i];
+        putU32(stringTable, i * StringEntrySize, quint32(stringData.size()));
+        putU32(stringTable, i * StringEntrySize + 4, quint32(value.size()));
+
+        QByteArray utf16(value.size() * 2, '\0');
+        qToLittleEndian<quint16>(value.utf16(), value.size(), utf16.data());
+        stringData += utf16;
+    }
+
+    // Все таблицы выровнены по 4 байта, данные строк - по 2 байта для прямого чтения QChar
+    const quint32 netTableOffset = HeaderSize;
+    const quint32 pinIndexOffset = netTableOffset + quint32(netTable.size());
+    const quint32 stringTableOffset = pinIndexOffset + quint32(pinTable.size());
+    const quint32 stringDataOffset = stringTableOffset + quint32(stringTable.size());
+
+    QByteArray header(HeaderSize, '\0');
+    memcpy(header.data(), Magic, 4);
+    putU16(header, 4, Version);
+    putU16(header, 6, 0);
+    putU32(header, 8, quint32(stringList.size()));
+    putU32(header, 12, stringTableOffset);
+    putU32(header, 16, stringDataOffset);
+    putU32(header, 20, quint32(nets.size()));
+    putU32(header, 24, netTableOffset);
+    putU32(header, 28, pinIndexOffset);
+
+    return device->write(header) == header.size()
+        && device->write(netTable) == netTable.size()
+        && device->write(pinTable) == pinTable.size()
+        && device->write(stringTable) == stringTable.size()
+        && device->write(stringData) == stringData.size();
+}
+
+bool ColorSchemeBinary::convert(const QString& inputFile, const QString& outputFile, QString* error) {
+    QList<SignalVisualizer::ConfigNet> nets;
+    bool toBinary = true;
+
+    QFile input(inputFile);
+    if (!input.open(QIODevice::ReadOnly)) {
+        if (error) *error = input.errorString();
+        return false;
+    }
+
+    if (ColorSchemeBinary::isBinaryFile(&input)) {
+        input.close();
+        toBinary = false;
+
+        ColorSchemeBinaryReader reader;
+        if (!reader.open(inputFile)) {
+            if (error) *error = reader.errorString();
+            return false;
+        }
+        nets.reserve(reader.netCount());
+        for (int i = 0; i < reader.netCount(); ++i) {
+            nets.append(reader.configNet(i));
+        }
+    } else {
+        CompressedDevice compressed(&input);
+        if (CompressedDevice::isCompressed(&input) && !compressed.open(QIODevice::ReadOnly)) {
+            if (error) *error = compressed.errorString();
+            return false;
+        }
+
+        QXmlStreamReader xml(compressed.isOpen() ? static_cast<QIODevice*>(&compressed) : &input);
+        if (!SignalVisualizer::parseConfigXml(xml, nets)) {
+            const QString reason = compressed.hasError() ? compressed.errorString() : xml.errorString();
+            if (error) *error = QString("%1: %2").arg(xml.lineNumber()).arg(reason);
+            return false;
+        }
+    }
+
+    QFile output(outputFile);
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = output.errorString();
+        return false;
+    }
+
+    if (toBinary) {
+        if (!write(&output, nets)) {
+            if (error) *error = output.errorString();
+            return false;
+        }
+    } else {
+        SignalVisualizer::writeConfigXml(&output, nets);
+    }
+    return true;
+}
+
+ColorSchemeBinaryReader::~ColorSchemeBinaryReader() {
+    close();
+}
+
+bool ColorSchemeBinaryReader::open(const QString& fileName) {
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+
+    m_size = m_file.size();
+    m_data = m_size >= HeaderSize ? m_file.map(0, m_size) : nullptr;
+    if (!m_data) {
+        m_error = m_size < HeaderSize ? QObject::tr("Файл слишком короткий") : m_file.errorString();
+        close();
+        return false;
+    }
+
+    if (memcmp(m_data, ColorSchemeBinary::Magic, 4) != 0
+        || qFromLittleEndian<quint16>(m_data + 4) != ColorSchemeBinary::Version) {
+        m_error = QObject::tr("Неподдерживаемый формат файла");
+        close();
+        return false;
+    }
+
+    m_stringCount = qFromLittleEndian<quint32>(m_data + 8);
+    m_stringTableOffset = qFromLittleEndian<quint32>(m_data + 12);
+    m_stringDataOffset = qFromLittleEndian<quint32>(m_data + 16);
+    m_netCount = qFromLittleEndian<quint32>(m_data + 20);
+    m_netTableOffset = qFromLittleEndian<quint32>(m_data + 24);
+    m_pinIndexOffset = qFromLittleEndian<quint32>(m_data + 28);
+
+    // Проверяем, что все таблицы целиком лежат внутри файла
+    const quint64 size = quint64(m_size);
+    if (quint64(m_netTableOffset) + quint64(m_netCount) * NetRecordSize > size
+        || quint64(m_stringTableOffset) + quint64(m_stringCount) * StringEntrySize > size
+        || m_pinIndexOffset > size
+        || m_stringDataOffset > size
+        || (m_stringDataOffset & 1)) {
+        m_error = QObject::tr("Файл повреждён");
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void ColorSchemeBinaryReader::close() {
+    if (m_data) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_size = 0;
+    m_stringCount = 0;
+    m_netCount = 0;
+    m_stringCache.clear();
+}
+
+const uchar* ColorSchemeBinaryReader::record(int net) const {
+    return m_data + m_netTableOffset + size_t(net) * NetRecordSize;
+}
+
+quint32 ColorSchemeBinaryReader::field(int net, int offset) const {
+    return qFromLittleEndian<quint32>(record(net) + offset);
+}
+
+quint64 ColorSchemeBinaryReader::fingerprint(int net) const {
+    if (net < 0 || quint32(net) >= m_netCount) return 0;
+    return qFromLittleEndian<quint64>(record(net) + FieldFingerprint);
+}
+
+QString ColorSchemeBinaryReader::stringView(quint32 index) const {
+    if (index >= m_stringCount) return QString();
+
+    const uchar* entry = m_data + m_stringTableOffset + size_t(index) * StringEntrySize;
+    const quint32 offset = qFromLittleEndian<quint32>(entry);
+    const quint32 length = qFromLittleEndian<quint32>(entry + 4);
+    if (quint64(m_stringDataOffset) + offset + quint64(length) * 2 > quint64(m_size)) return QString();
+
+    const uchar* chars = m_data + m_stringDataOffset + offset;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    // Строка ссылается на отображённую память без копирования
+    return QString::fromRawData(reinterpret_cast<const QChar*>(chars), int(length));
+#else
+    QString value(int(length), Qt::Uninitialized);
+    qFromLittleEndian<quint16>(chars, length, value.data());
+    return value;
+#endif
+}
+
+QString ColorSchemeBinaryReader::copiedString(quint32 index) const {
+    // Повторяющиеся строки копируются один раз и дальше разделяются неявно
+    auto it = m_stringCache.constFind(index);
+    if (it != m_stringCache.cend()) return it.value();
+
+    QString view = stringView(index);
+    QString value(view.constData(), view.size());
+    m_stringCache.insert(index, value);
+    return value;
+}
+
+QSet<QString> ColorSchemeBinaryReader::pinIds(int net) const {
+    return collectPinIds(net, false);
+}
+
+QSet<QString> ColorSchemeBinaryReader::collectPinIds(int net, bool copy) const {
+    QSet<QString> result;
+    if (net < 0 || quint32(net) >= m_netCount) return result;
+
+    const quint32 first = field(net, FieldPinFirst);
+    const quint32 count = field(net, FieldPinCount);
+    if (quint64(m_pinIndexOffset) + (quint64(first) + count) * 4 > quint64(m_size)) return result;
+
+    result.reserve(int(count));
+    const uchar* pins = m_data + m_pinIndexOffset + size_t(first) * 4;
+    for (quint32 i = 0; i < count; ++i) {
+        const quint32 index = qFromLittleEndian<quint32>(pins + i * 4);
+        result.insert(copy ? copiedString(index) : stringView(index));
+    }
+    return result;
+}
+
+SignalVisualizer::ConfigNet ColorSchemeBinaryReader::configNet(int net, bool withPins) const {
+    SignalVisualizer::ConfigNet result;
+    if (net < 0 || quint32(net) >= m_netCount) return result;
+
+    const quint32 designationColor = field(net, FieldDesignationColor);
+    const quint32 typeColor = field(net, FieldTypeColor);
+
+    result.name = copiedString(field(net, FieldName));
+    result.attributes.designation = copiedString(field(net, FieldDesignation));
+    result.attributes.designationInfo = copiedString(field(net, FieldDesignationInfo));
+    result.attributes.type = copiedString(field(net, FieldType));
+    result.attributes.typeInfo = copiedString(field(net, FieldTypeInfo));
+    if (designationColor) result.attributes.designationColor = QColor::fromRgba(designationColor);
+    if (typeColor) result.attributes.typeColor = QColor::fromRgba(typeColor);
+    result.lineWidth = int(field(net, FieldLineWidth));
+    result.fingerprint = fingerprint(net);
+    if (withPins) result.pinIds = collectPinIds(net, true);
+    return result;
+}
@@ -0,0 +1,72 @@
+#ifndef COLORSCHEMEBINARY_H
+#define COLORSCHEMEBINARY_H
+
+#include <QFile>
+#include <QHash>
+#include <QIODevice>
+#include <QSet>
+#include <QString>
+#include "signalvisualizer.h"
+
+// Двоичный формат цветовой схемы (.cscb), все числа little-endian:
+//   заголовок      magic "CSCB", версия, размеры и смещения таблиц
+//   таблица сетей  записи фиксированного размера, ключ - отпечаток набора пинов
+//   индекс пинов   номера строк идентификаторов пинов
+//   таблица строк  смещение и длина каждой строки
+//   данные строк   UTF-16, каждая уникальная строка хранится один раз
+class ColorSchemeBinary {
+public:
+    static const char Magic[4];
+    static const quint16 Version = 1;
+
+    static bool isBinary(const QByteArray& header);
+    static bool isBinaryFile(QIODevice* device);
+
+    static bool write(QIODevice* device, const QList<SignalVisualizer::ConfigNet>& nets);
+
+    static bool convert(const QString& inputFile, const QString& outputFile, QString* error = nullptr);
+};
+
+// Чтение двоичной схемы через отображение файла в память.
+// Строки возвращаются как представления поверх отображения и живут не дольше читателя.
+class ColorSchemeBinaryReader {
+public:
+    ColorSchemeBinaryReader() = default;
+    ~ColorSchemeBinaryReader();
+
+    bool open(const QString& fileName);
+    void close();
+    QString errorString() const { return m_error; }
+
+    int netCount() const { return int(m_netCount); }
+    quint64 fingerprint(int net) const;
+    QString stringView(quint32 index) const;
+
+    // Пины как представления поверх отображения: для сравнения, не для хранения
+    QSet<QString> pinIds(int net) const;
+
+    // Сеть с глубокими копиями строк, пригодная для хранения после закрытия файла
+    SignalVisualizer::ConfigNet configNet(int net, bool withPins = true) const;
+
+private:
+    const uchar* record(int net) const;
+    quint32 field(int net, int offset) const;
+    QString copiedString(quint32 index) const;
+    QSet<QString> collectPinIds(int net, bool copy) const;
+
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    qint64 m_size = 0;
+    QString m_error;
+
+    quint32 m_stringCount = 0;
+    quint32 m_stringTableOffset = 0;
+    quint32 m_stringDataOffset = 0;
+    quint32 m_netCount = 0;
+    quint32 m_netTableOffset = 0;
+    quint32 m_pinIndexOffset = 0;
+
+    mutable QHash<quint32, QString> m_stringCache;
+};
+
+#endif // COLORSCHEMEBINARY_H
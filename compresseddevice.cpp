@@ -0,0 +1,183 @@
+#include <QtEndian>
+#include "compresseddevice.h"
+
+namespace {
+    const char Magic[4] = {'C', 'S', 'C', 'Z'};
+    const quint16 Version = 1;
+    const int HeaderSize = 10;
+    const int MinBlockSize = 4096;
+    const int MaxBlockSize = 16 * 1024 * 1024;
+
+    // Верхняя граница размера qCompress для блока: оценка compressBound() из zlib
+    // и четыре байта длины исходных данных перед потоком zlib
+    quint32 compressedBound(int blockSize) {
+        const quint32 size = quint32(blockSize);
+        return size + (size >> 12) + (size >> 14) + (size >> 25) + 13 + 4;
+    }
+}
+
+CompressedDevice::CompressedDevice(QIODevice* target, int blockSize, QObject* parent)
+    : QIODevice(parent), m_target(target), m_blockSize(qBound(MinBlockSize, blockSize, MaxBlockSize)) {
+}
+
+CompressedDevice::~CompressedDevice() {
+    close();
+}
+
+bool CompressedDevice::isCompressed(QIODevice* device) {
+    return device && device->peek(4) == QByteArray(Magic, 4);
+}
+
+bool CompressedDevice::open(OpenMode mode) {
+    // Поток читается или пишется только целиком и только в одну сторону
+    if ((mode & ReadWrite) == ReadWrite || !m_target || !m_target->isOpen()) return false;
+
+    m_block.clear();
+    m_blockPos = 0;
+    m_finished = false;
+    m_failed = false;
+
+    if (mode & WriteOnly) {
+        char header[HeaderSize];
+        memcpy(header, Magic, 4);
+        qToLittleEndian<quint16>(Version, header + 4);
+        qToLittleEndian<quint32>(quint32(m_blockSize), header + 6);
+        if (m_target->write(header, HeaderSize) != HeaderSize) return false;
+        m_block.reserve(m_blockSize);
+    } else {
+        QByteArray header = m_target->read(HeaderSize);
+        if (header.size() != HeaderSize || !header.startsWith(QByteArray(Magic, 4))
+            || qFromLittleEndian<quint16>(header.constData() + 4) != Version) {
+            setErrorString(tr("Неподдерживаемый формат сжатия"));
+            return false;
+        }
+
+        // Размер блока задан пишущей стороной; по нему же ограничивается длина блоков
+        const quint32 blockSize = qFromLittleEndian<quint32>(header.constData() + 6);
+        if (blockSize < quint32(MinBlockSize) || blockSize > quint32(MaxBlockSize)) {
+            setErrorString(tr("Неподдерживаемый формат сжатия"));
+            return false;
+        }
+        m_blockSize = int(blockSize);
+    }
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void CompressedDevice::close() {
+    if (!isOpen()) return;
+
+    if (openMode() & WriteOnly) finish();
+    m_block.clear();
+    QIODevice::close();
+}
+
+bool CompressedDevice::finish() {
+    if (!isOpen() || !(openMode() & WriteOnly) || m_finished) return !m_failed;
+
+    m_finished = true;
+    if (!writeBlock()) return false;
+
+    char end[4] = {0, 0, 0, 0};
+    if (m_target->write(end, 4) != 4) {
+        setErrorString(m_target->errorString());
+        m_failed = true;
+    }
+    return !m_failed;
+}
+
+bool CompressedDevice::atEnd() const {
+    return m_finished && m_blockPos >= m_block.size();
+}
+
+qint64 CompressedDevice::bytesAvailable() const {
+    return (m_block.size() - m_blockPos) + QIODevice::bytesAvailable();
+}
+
+qint64 CompressedDevice::writeData(const char* data, qint64 size) {
+    qint64 written = 0;
+    while (written < size) {
+        int chunk = int(qMin<qint64>(size - written, m_blockSize - m_block.size()));
+        m_block.append(data + written, chunk);
+        written += chunk;
+
+        if (m_block.size() >= m_blockSize && !writeBlock()) {
+            return -1;
+        }
+    }
+    return written;
+}
+
+qint64 CompressedDevice::readData(char* data, qint64 maxSize) {
+    qint64 read = 0;
+    while (read < maxSize) {
+        if (m_blockPos >= m_block.size() && !readBlock()) break;
+
+        int chunk = int(qMin<qint64>(maxSize - read, m_block.size() - m_blockPos));
+        memcpy(data + read, m_block.constData() + m_blockPos, size_t(chunk));
+        m_blockPos += chunk;
+        read += chunk;
+    }
+    // Повреждённый поток не должен выглядеть как обычный конец данных
+    return m_failed ? -1 : read;
+}
+
+bool CompressedDevice::writeBlock() {
+    if (m_block.isEmpty()) return true;
+
+    QByteArray compressed = qCompress(m_block, m_level);
+    char size[4];
+    qToLittleEndian<quint32>(quint32(compressed.size()), size);
+
+    bool ok = m_target->write(size, 4) == 4
+           && m_target->write(compressed) == compressed.size();
+    if (!ok) {
+        setErrorString(m_target->errorString());
+        m_failed = true;
+    }
+
+    m_block.clear();
+    return ok;
+}
+
+bool CompressedDevice::readBlock() {
+    m_block.clear();
+    m_blockPos = 0;
+    if (m_finished) return false;
+
+    QByteArray size = m_target->read(4);
+    if (size.size() != 4) {
+        return readFailed(tr("Файл обрезан"));
+    }
+
+    quint32 length = qFromLittleEndian<quint32>(size.constData());
+    if (length == 0) {
+        m_finished = true;
+        return false;
+    }
+
+    // Длина и заявленный размер распакованных данных проверяются до выделения памяти:
+    // повреждённый заголовок не должен приводить к чтению или распаковке гигабайтов
+    if (length > compressedBound(m_blockSize)) {
+        return readFailed(tr("Повреждённый блок данных"));
+    }
+
+    QByteArray compressed = m_target->read(length);
+    if (compressed.size() != int(length) || compressed.size() < 4
+        || qFromBigEndian<quint32>(compressed.constData()) > quint32(m_blockSize)) {
+        return readFailed(tr("Повреждённый блок данных"));
+    }
+
+    m_block = qUncompress(compressed);
+    if (m_block.isEmpty()) {
+        return readFailed(tr("Повреждённый блок данных"));
+    }
+    return true;
+}
+
+bool CompressedDevice::readFailed(const QString& error) {
+    setErrorString(error);
+    m_block.clear();
+    m_finished = true;
+    m_failed = true;
+    return false;
+}
@@ -0,0 +1,52 @@
+#ifndef COMPRESSEDDEVICE_H
+#define COMPRESSEDDEVICE_H
+
+#include <QIODevice>
+#include <QByteArray>
+
+// Потоковое сжатие поверх другого устройства.
+// Данные делятся на блоки фиксированного размера, каждый блок сжимается отдельно,
+// поэтому в памяти одновременно находится не больше одного блока.
+// Формат: "CSCZ", версия, размер блока, затем блоки [u32 размер][qCompress],
+// блок нулевой длины завершает поток. Читающая сторона берёт размер блока из заголовка
+// и отвергает блоки длиннее, чем даёт сжатие блока такого размера.
+class CompressedDevice : public QIODevice {
+    Q_OBJECT
+public:
+    // blockSize используется при записи; при чтении размер блока задаёт заголовок потока
+    explicit CompressedDevice(QIODevice* target, int blockSize = 64 * 1024, QObject* parent = nullptr);
+    ~CompressedDevice();
+
+    static bool isCompressed(QIODevice* device);
+
+    bool open(OpenMode mode) override;
+    void close() override;
+
+    // Дописывает последний блок и конец потока; false, если какая-либо запись не удалась
+    bool finish();
+
+    // Запись или чтение прервались ошибкой, текст в errorString()
+    bool hasError() const { return m_failed; }
+    bool isSequential() const override { return true; }
+    bool atEnd() const override;
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 size) override;
+
+private:
+    bool writeBlock();
+    bool readBlock();
+    bool readFailed(const QString& error);
+
+    QIODevice* m_target;
+    int m_blockSize;
+    int m_level = 9;
+    QByteArray m_block;
+    int m_blockPos = 0;
+    bool m_finished = false;
+    bool m_failed = false;
+};
+
+#endif // COMPRESSEDDEVICE_H
@@ -0,0 +1,164 @@
+#include <QSaveFile>
+#include <QtConcurrent>
+#include "configautosaver.h"
+#include "colorschemebinary.h"
+#include "compresseddevice.h"
+
+ConfigAutosaver::ConfigAutosaver(SignalVisualizer* model, QObject* parent)
+    : QObject(parent), m_model(model) {
+    // Один поток записи сохраняет порядок: дописывания журнала и свёртка не обгоняют друг друга
+    m_writer.setMaxThreadCount(1);
+    m_timer.setInterval(3000);
+    connect(&m_timer, &QTimer::timeout, this, &ConfigAutosaver::autosave);
+}
+
+ConfigAutosaver::~ConfigAutosaver() {
+    m_timer.stop();
+    m_writer.waitForDone();
+}
+
+int ConfigAutosaver::setFileName(const QString& fileName) {
+    m_writer.waitForDone();
+    m_fileName = fileName;
+    m_appendsSinceCompaction = 0;
+
+    if (m_fileName.isEmpty()) {
+        m_timer.stop();
+        return 0;
+    }
+
+    // Модель только что загружена из этого файла
+    m_model->clearDirtyNets();
+
+    QList<SignalVisualizer::ConfigNet> nets;
+    QFile journal(journalFileName(fileName));
+    if (journal.open(QIODevice::ReadOnly)) {
+        // Журнал - последовательность элементов net без общего корня
+        QXmlStreamReader xml(QByteArray("<journal>") + journal.readAll() + QByteArray("</journal>"));
+        SignalVisualizer::parseConfigXml(xml, nets);
+        journal.close();
+    }
+
+    if (!nets.isEmpty()) {
+        // Записи применяются по порядку, поздние перекрывают ранние
+        m_model->applyConfigNets(nets);
+        compact(fileName, false);
+    }
+
+    m_timer.start();
+    return nets.size();
+}
+
+void ConfigAutosaver::setInterval(int ms) {
+    m_timer.setInterval(qMax(100, ms));
+}
+
+void ConfigAutosaver::setCompactionThreshold(int appends) {
+    m_compactionAppends = qMax(1, appends);
+}
+
+void ConfigAutosaver::save(const QString& fileName) {
+    m_fileName = fileName;
+    compact(fileName, true);
+    if (!m_timer.isActive()) m_timer.start();
+}
+
+void ConfigAutosaver::flush() {
+    autosave();
+    m_writer.waitForDone();
+}
+
+QString ConfigAutosaver::journalFileName(const QString& fileName) {
+    return fileName + ".journal";
+}
+
+void ConfigAutosaver::autosave() {
+    if (m_fileName.isEmpty()) return;
+
+    QList<SignalVisualizer::ConfigNet> nets = m_model->takeDirtyNets();
+    if (nets.isEmpty()) return;
+
+    if (++m_appendsSinceCompaction >= m_compactionAppends) {
+        compact(m_fileName, false);
+        return;
+    }
+
+    const QString journal = journalFileName(m_fileName);
+    QtConcurrent::run(&m_writer, [this, journal, nets]() {
+        QString error = appendJournal(journal, nets);
+        if (!error.isEmpty()) emit autosaveFailed(error);
+    });
+}
+
+void ConfigAutosaver::compact(const QString& fileName, bool notify) {
+    // Журнал удаляется после свёртки, поэтому незавершённые дописывания должны лечь раньше
+    m_writer.waitForDone();
+    m_model->clearDirtyNets();
+    m_appendsSinceCompaction = 0;
+
+    QString error = writeFullConfig(fileName, m_compress);
+    if (error.isEmpty()) {
+        QFile::remove(journalFileName(fileName));
+    }
+
+    if (notify) emit saveFinished(fileName, error);
+    else if (!error.isEmpty()) emit autosaveFailed(error);
+}
+
+QString ConfigAutosaver::appendJournal(const QString& journal, const QList<SignalVisualizer::ConfigNet>& nets) {
+    QFile file(journal);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return file.errorString();
+    }
+
+    QXmlStreamWriter xml(&file);
+    xml.setAutoFormatting(true);
+    xml.setAutoFormattingIndent(2);
+    for (const SignalVisualizer::ConfigNet& configNet : nets) {
+        SignalVisualizer::writeConfigNet(xml, configNet);
+    }
+    xml.writeCharacters("\n");
+
+    file.close();
+    return file.error() == QFileDevice::NoError ? QString() : file.errorString();
+}
+
+QString ConfigAutosaver::writeFullConfig(const QString& fileName, bool compress) const {
+    // Файл заменяется целиком только после успешной записи
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return file.errorString();
+    }
+
+    if (fileName.endsWith(".cscb")) {
+        // Двоичный формат начинается с общей таблицы строк, поэтому ему нужен снимок всех сетей
+        if (!ColorSchemeBinary::write(&file, m_model->configNets())) {
+            const QString error = file.errorString();
+            file.cancelWriting();
+            return error;
+        }
+    } else if (compress) {
+        // XML сжимается по блокам по мере записи, целиком документ в памяти не собирается
+        CompressedDevice compressed(&file);
+        if (!compressed.open(QIODevice::WriteOnly)) {
+            file.cancelWriting();
+            return file.errorString();
+        }
+        const bool written = m_model->writeConfig(&compressed, true);
+        if (!compressed.finish() || !written) {
+            const QString error = compressed.errorString();
+            file.cancelWriting();
+            return error;
+        }
+        compressed.close();
+    } else if (!m_model->writeConfig(&file)) {
+        const QString error = file.errorString();
+        file.cancelWriting();
+        return error;
+    }
+
+    if (!file.commit()) {
+        return file.errorString();
+    }
+    return QString();
+}
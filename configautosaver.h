@@ -0,0 +1,60 @@
+#ifndef CONFIGAUTOSAVER_H
+#define CONFIGAUTOSAVER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QThreadPool>
+#include "signalvisualizer.h"
+
+// Автосохранение цветовой схемы.
+// Изменённые сети дописываются в журнал рядом с файлом схемы фоновым потоком, журнал периодически
+// сворачивается в полный файл. Полный XML пишется из модели потоком по одной сети в GUI-потоке:
+// копия всей схемы для фоновой записи заняла бы столько же памяти, сколько сам документ.
+class ConfigAutosaver : public QObject {
+    Q_OBJECT
+public:
+    explicit ConfigAutosaver(SignalVisualizer* model, QObject* parent = nullptr);
+    ~ConfigAutosaver();
+
+    // Привязка к файлу схемы; несохранённые изменения из его журнала применяются к модели
+    int setFileName(const QString& fileName);
+    QString fileName() const { return m_fileName; }
+
+    void setInterval(int ms);
+    void setCompactionThreshold(int appends);
+
+    // Полные XML-файлы пишутся сжатыми, с общей таблицей описаний
+    void setCompression(bool enabled) { m_compress = enabled; }
+    bool compression() const { return m_compress; }
+
+    // Полная запись схемы, результат приходит в saveFinished
+    void save(const QString& fileName);
+
+    // Дописать накопленные изменения и дождаться окончания записи
+    void flush();
+
+    static QString journalFileName(const QString& fileName);
+
+signals:
+    void saveFinished(const QString& fileName, const QString& error);
+    void autosaveFailed(const QString& error);
+
+private slots:
+    void autosave();
+
+private:
+    void compact(const QString& fileName, bool notify);
+
+    static QString appendJournal(const QString& journal, const QList<SignalVisualizer::ConfigNet>& nets);
+    QString writeFullConfig(const QString& fileName, bool compress) const;
+
+    SignalVisualizer* m_model;
+    QTimer m_timer;
+    QThreadPool m_writer;
+    QString m_fileName;
+    int m_appendsSinceCompaction = 0;
+    int m_compactionAppends = 20;
+    bool m_compress = false;
+};
+
+#endif // CONFIGAUTOSAVER_H
@@ -0,0 +1,85 @@
+#include <QEvent>
+#include <QFontMetricsF>
+#include <QPainter>
+#include <QtMath>
+#include "legendwidget.h"
+
+namespace {
+    constexpr qreal Padding = 10.0;
+    constexpr qreal Spacing = 5.0;
+    constexpr qreal Swatch = 20.0;
+    constexpr qreal TextGap = 6.0;
+}
+
+LegendWidget::LegendWidget(QWidget* parent) : QWidget(parent) {
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+bool LegendWidget::setEntries(const QVector<Entry>& entries) {
+    if (entries == m_entries) return false;
+
+    m_entries = entries;
+    relayout();
+    return true;
+}
+
+QSize LegendWidget::sizeHint() const {
+    return QSize(qCeil(m_layout.size.width()), qCeil(m_layout.size.height()));
+}
+
+void LegendWidget::relayout() {
+    m_layout = computeLayout(m_entries, font());
+    updateGeometry();
+    resize(sizeHint());
+    update();
+}
+
+LegendWidget::Layout LegendWidget::computeLayout(const QVector<Entry>& entries, const QFont& font) {
+    QFontMetricsF metrics(font);
+    const qreal rowHeight = qMax(Swatch, metrics.height());
+
+    Layout layout;
+    layout.swatches.reserve(entries.size());
+    layout.labels.reserve(entries.size());
+
+    qreal textWidth = 0;
+    qreal y = Padding;
+    for (const Entry& entry : entries) {
+        const qreal width = metrics.horizontalAdvance(entry.label);
+        textWidth = qMax(textWidth, width);
+
+        layout.swatches.append(QRectF(Padding, y + (rowHeight - Swatch) / 2, Swatch, Swatch));
+        layout.labels.append(QRectF(Padding + Swatch + TextGap, y, width, rowHeight));
+        y += rowHeight + Spacing;
+    }
+
+    if (entries.isEmpty()) return layout;
+    layout.size = QSizeF(2 * Padding + Swatch + TextGap + textWidth, y - Spacing + Padding);
+    return layout;
+}
+
+void LegendWidget::paintLegend(QPainter* painter, const QPointF& origin, const Layout& layout, const QVector<Entry>& entries) {
+    painter->save();
+    painter->translate(origin);
+    painter->setPen(QPen(Qt::black, 1));
+    painter->setBrush(Qt::white);
+    painter->drawRect(QRectF(QPointF(0.5, 0.5), layout.size - QSizeF(1, 1)));
+
+    for (int i = 0; i < entries.size() && i < layout.swatches.size(); ++i) {
+        painter->setBrush(entries[i].color);
+        painter->drawRect(layout.swatches[i]);
+        painter->drawText(layout.labels[i], Qt::AlignLeft | Qt::AlignVCenter, entries[i].label);
+    }
+    painter->restore();
+}
+
+void LegendWidget::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.setFont(font());
+    paintLegend(&painter, QPointF(0, 0), m_layout, m_entries);
+}
+
+void LegendWidget::changeEvent(QEvent* event) {
+    if (event->type() == QEvent::FontChange) relayout();
+    QWidget::changeEvent(event);
+}
@@ -0,0 +1,53 @@
+#ifndef LEGENDWIDGET_H
+#define LEGENDWIDGET_H
+
+#include <QColor>
+#include <QFont>
+#include <QRectF>
+#include <QVector>
+#include <QWidget>
+
+class QPainter;
+
+// Легенда цветов, рисуемая одним виджетом.
+// Раскладка строк считается только при смене набора записей или шрифта.
+class LegendWidget : public QWidget {
+    Q_OBJECT
+public:
+    struct Entry {
+        QColor color;
+        QString label;
+
+        bool operator==(const Entry& other) const { return color == other.color && label == other.label; }
+        bool operator!=(const Entry& other) const { return !(*this == other); }
+    };
+
+    struct Layout {
+        QSizeF size;
+        QVector<QRectF> swatches;
+        QVector<QRectF> labels;
+    };
+
+    explicit LegendWidget(QWidget* parent = nullptr);
+
+    // false, если записи не изменились и раскладка осталась прежней
+    bool setEntries(const QVector<Entry>& entries);
+    const QVector<Entry>& entries() const { return m_entries; }
+
+    QSize sizeHint() const override;
+
+    static Layout computeLayout(const QVector<Entry>& entries, const QFont& font);
+    static void paintLegend(QPainter* painter, const QPointF& origin, const Layout& layout, const QVector<Entry>& entries);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void changeEvent(QEvent* event) override;
+
+private:
+    void relayout();
+
+    QVector<Entry> m_entries;
+    Layout m_layout;
+};
+
+#endif // LEGENDWIDGET_H
@@ -0,0 +1,150 @@
+#include <QMouseEvent>
+#include <QPainter>
+#include <QtConcurrent>
+#include "minimapwidget.h"
+
+namespace {
+    constexpr int Padding = 4;
+}
+
+MinimapWidget::MinimapWidget(QWidget* parent) : QWidget(parent) {
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setCursor(Qt::PointingHandCursor);
+    connect(&m_renderWatcher, &QFutureWatcher<QImage>::finished, this, &MinimapWidget::renderFinished);
+}
+
+MinimapWidget::~MinimapWidget() {
+    m_renderWatcher.waitForFinished();
+}
+
+void MinimapWidget::setSnapshot(const Snapshot& snapshot) {
+    // Пока идёт отрисовка, хранится только последний снимок, промежуточные не нужны
+    m_pendingSnapshot = snapshot;
+    m_hasPendingSnapshot = true;
+    if (!m_renderWatcher.isRunning()) startRender();
+}
+
+void MinimapWidget::setViewportRect(const QRectF& sceneRect) {
+    if (sceneRect == m_viewportRect) return;
+    m_viewportRect = sceneRect;
+    update();
+}
+
+void MinimapWidget::startRender() {
+    m_hasPendingSnapshot = false;
+    m_renderingSceneRect = m_pendingSnapshot.sceneRect;
+
+    const QSize size = rect().adjusted(Padding, Padding, -Padding, -Padding).size();
+    Snapshot snapshot;
+    std::swap(snapshot, m_pendingSnapshot);
+    m_renderWatcher.setFuture(QtConcurrent::run([snapshot, size]() {
+        return render(snapshot, size);
+    }));
+}
+
+void MinimapWidget::renderFinished() {
+    m_image = m_renderWatcher.result();
+    m_imageSceneRect = m_renderingSceneRect;
+    update();
+
+    if (m_hasPendingSnapshot) startRender();
+}
+
+QImage MinimapWidget::render(const Snapshot& snapshot, const QSize& size) {
+    if (snapshot.sceneRect.isEmpty() || size.isEmpty()) return QImage();
+
+    const qreal scale = qMin(size.width() / snapshot.sceneRect.width(),
+                             size.height() / snapshot.sceneRect.height());
+    const QSize imageSize(qMax(1, qRound(snapshot.sceneRect.width() * scale)),
+                          qMax(1, qRound(snapshot.sceneRect.height() * scale)));
+
+    QImage image(imageSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.scale(scale, scale);
+    painter.translate(-snapshot.sceneRect.topLeft());
+
+    QPen componentPen(QColor(150, 150, 150));
+    componentPen.setCosmetic(true);
+    painter.setPen(componentPen);
+    painter.setBrush(QColor(235, 235, 235));
+    for (const QRectF& component : snapshot.components) {
+        painter.drawRect(component);
+    }
+
+    // Толщина сохраняет соотношение между цепями, но не меньше пикселя
+    QPen wirePen;
+    wirePen.setCosmetic(true);
+    for (int i = 0; i < snapshot.lines.size(); ++i) {
+        wirePen.setColor(snapshot.colors[i]);
+        wirePen.setWidthF(qMax(1.0, snapshot.widths[i] * scale));
+        painter.setPen(wirePen);
+        painter.drawLine(snapshot.lines[i]);
+    }
+    return image;
+}
+
+QRectF MinimapWidget::imageRect() const {
+    if (m_image.isNull()) return QRectF();
+
+    const QRectF area = QRectF(rect()).adjusted(Padding, Padding, -Padding, -Padding);
+    QSizeF size = QSizeF(m_image.size()).scaled(area.size(), Qt::KeepAspectRatio);
+    QRectF target(QPointF(), size);
+    target.moveCenter(area.center());
+    return target;
+}
+
+QPointF MinimapWidget::toScene(const QPointF& pos) const {
+    const QRectF target = imageRect();
+    if (target.isEmpty()) return QPointF();
+
+    return QPointF(
+        m_imageSceneRect.left() + (pos.x() - target.left()) / target.width() * m_imageSceneRect.width(),
+        m_imageSceneRect.top() + (pos.y() - target.top()) / target.height() * m_imageSceneRect.height());
+}
+
+QRectF MinimapWidget::toMinimap(const QRectF& sceneRect) const {
+    const QRectF target = imageRect();
+    if (target.isEmpty() || m_imageSceneRect.isEmpty()) return QRectF();
+
+    const qreal sx = target.width() / m_imageSceneRect.width();
+    const qreal sy = target.height() / m_imageSceneRect.height();
+    return QRectF(target.left() + (sceneRect.left() - m_imageSceneRect.left()) * sx,
+                  target.top() + (sceneRect.top() - m_imageSceneRect.top()) * sy,
+                  sceneRect.width() * sx,
+                  sceneRect.height() * sy);
+}
+
+void MinimapWidget::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(255, 255, 255));
+    painter.setPen(Qt::black);
+    painter.drawRect(rect().adjusted(0, 0, -1, -1));
+
+    // Готовое изображение только переносится, сцена здесь не рисуется
+    const QRectF target = imageRect();
+    if (target.isEmpty()) return;
+    painter.drawImage(target, m_image);
+
+    const QRectF viewport = toMinimap(m_viewportRect).intersected(target);
+    if (viewport.isEmpty()) return;
+    painter.setPen(QPen(QColorConstants::Svg::orange, 2));
+    painter.setBrush(QColor(255, 165, 0, 40));
+    painter.drawRect(viewport);
+}
+
+void MinimapWidget::mousePressEvent(QMouseEvent* event) {
+    if (event->button() != Qt::LeftButton) return;
+    m_dragging = true;
+    emit navigateRequested(toScene(event->pos()));
+}
+
+void MinimapWidget::mouseMoveEvent(QMouseEvent* event) {
+    if (m_dragging) emit navigateRequested(toScene(event->pos()));
+}
+
+void MinimapWidget::mouseReleaseEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton) m_dragging = false;
+}
@@ -0,0 +1,63 @@
+#ifndef MINIMAPWIDGET_H
+#define MINIMAPWIDGET_H
+
+#include <QColor>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QLineF>
+#include <QRectF>
+#include <QVector>
+#include <QWidget>
+
+// Обзорная карта схемы с рамкой видимой области.
+// Схема рисуется в фоне в изображение низкого разрешения по снимку проводов и компонентов,
+// перерисовка рамки и перетаскивание по карте сцену не затрагивают.
+class MinimapWidget : public QWidget {
+    Q_OBJECT
+public:
+    // Копия геометрии сцены, которую можно рисовать вне GUI-потока
+    struct Snapshot {
+        QRectF sceneRect;
+        QVector<QLineF> lines;
+        QVector<QColor> colors;
+        QVector<qreal> widths;
+        QVector<QRectF> components;
+    };
+
+    explicit MinimapWidget(QWidget* parent = nullptr);
+    ~MinimapWidget();
+
+    void setSnapshot(const Snapshot& snapshot);
+    void setViewportRect(const QRectF& sceneRect);
+
+    static QImage render(const Snapshot& snapshot, const QSize& size);
+
+signals:
+    void navigateRequested(const QPointF& scenePos);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+
+private:
+    void startRender();
+    void renderFinished();
+
+    QRectF imageRect() const;
+    QPointF toScene(const QPointF& pos) const;
+    QRectF toMinimap(const QRectF& sceneRect) const;
+
+    QFutureWatcher<QImage> m_renderWatcher;
+    Snapshot m_pendingSnapshot;
+    bool m_hasPendingSnapshot = false;
+
+    QRectF m_renderingSceneRect;
+    QImage m_image;
+    QRectF m_imageSceneRect;    // область сцены, изображённая на m_image
+    QRectF m_viewportRect;
+    bool m_dragging = false;
+};
+
+#endif // MINIMAPWIDGET_H
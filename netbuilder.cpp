@@ -0,0 +1,91 @@
+#include <QHash>
+#include <QRegularExpression>
+#include <QSet>
+#include "netbuilder.h"
+
+bool NetBuilder::isNodePin(const QString& pinId) {
+    return pinId.contains("Node", Qt::CaseInsensitive);
+}
+
+QString NetBuilder::nodeGroup(const QString& pinId) {
+    static const QRegularExpression regex("^Node-(\\d+)-", QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch match = regex.match(pinId);
+    return match.hasMatch() ? match.captured(1) : QString();
+}
+
+QString NetBuilder::newNetKey(const QString& startId, const QString& endId) {
+    // Цепь называется по пину компонента, а не по пину узла
+    bool startIsNode = isNodePin(startId);
+    bool endIsNode = isNodePin(endId);
+    return (!startIsNode && endIsNode) ? startId : (startIsNode && !endIsNode) ? endId : startId;
+}
+
+void NetBuilder::addConnection(const QString& startId, const QString& endId) {
+    QString keyStart = isNodePin(startId) ? findKeyForNode(startId) : findKeyForPin(startId);
+    QString keyEnd = isNodePin(endId) ? findKeyForNode(endId) : findKeyForPin(endId);
+    QString targetKey = !keyStart.isEmpty() ? keyStart : keyEnd;
+
+    if (targetKey.isEmpty()) {
+        m_nets[newNetKey(startId, endId)] = QStringList{startId, endId};
+        return;
+    }
+
+    m_nets[targetKey] << startId << endId;
+    if (!keyStart.isEmpty() && !keyEnd.isEmpty() && keyStart != keyEnd) {
+        mergeNodeGroups();
+    }
+}
+
+QString NetBuilder::findKeyForPin(const QString& pinId) const {
+    for (auto it = m_nets.cbegin(); it != m_nets.cend(); ++it) {
+        if (it.value().contains(pinId)) return it.key();
+    }
+    return QString();
+}
+
+QString NetBuilder::findKeyForNode(const QString& pinId) const {
+    static const QRegularExpression regex("^Node-(\\d+)-\\d+$", QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch match = regex.match(pinId);
+    if (!match.hasMatch()) return QString();
+
+    const QString group = match.captured(1);
+    for (auto it = m_nets.cbegin(); it != m_nets.cend(); ++it) {
+        for (const QString& other : it.value()) {
+            QRegularExpressionMatch otherMatch = regex.match(other);
+            if (otherMatch.hasMatch() && otherMatch.captured(1) == group) {
+                return it.key();
+            }
+        }
+    }
+    return QString();
+}
+
+void NetBuilder::mergeNodeGroups() {
+    QHash<QString, QSet<QString>> nodeGroups;
+    for (auto it = m_nets.cbegin(); it != m_nets.cend(); ++it) {
+        for (const QString& pinId : it.value()) {
+            QString group = nodeGroup(pinId);
+            if (!group.isEmpty()) nodeGroups[group].insert(it.key());
+        }
+    }
+
+    QList<QString> keysToRemove;
+    for (const QSet<QString>& group : nodeGroups) {
+        if (group.size() < 2) continue;
+
+        QString mainKey = *group.begin();
+        if (!m_nets.contains(mainKey)) continue;
+
+        QSet<QString> uniquePins(m_nets[mainKey].begin(), m_nets[mainKey].end());
+        for (const QString& key : group) {
+            if (key == mainKey || !m_nets.contains(key)) continue;
+            uniquePins.unite(QSet<QString>(m_nets[key].begin(), m_nets[key].end()));
+            keysToRemove.append(key);
+        }
+        m_nets[mainKey] = QStringList(uniquePins.begin(), uniquePins.end());
+    }
+
+    for (const QString& key : keysToRemove) {
+        m_nets.remove(key);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef NETBUILDER_H
+#define NETBUILDER_H
+
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+// Сборка цепей по идентификаторам пинов на концах проводников, без объектов сцены.
+// Используется и при построении сцены (SignalVisualizer::updateConnectionsMap), и пакетной классификацией,
+// поэтому ключи цепей в окне и в отчётах совпадают.
+class NetBuilder {
+public:
+    void addConnection(const QString& startId, const QString& endId);
+    const QMap<QString, QStringList>& nets() const { return m_nets; }
+
+    static bool isNodePin(const QString& pinId);
+    static QString nodeGroup(const QString& pinId);
+    static QString newNetKey(const QString& startId, const QString& endId);
+
+private:
+    QString findKeyForPin(const QString& pinId) const;
+    QString findKeyForNode(const QString& pinId) const;
+    void mergeNodeGroups();
+
+    QMap<QString, QStringList> m_nets;
+};
+
+#endif // NETBUILDER_H
@@ -0,0 +1,153 @@
+#include <QHeaderView>
+#include <QItemSelectionModel>
+#include <QLineEdit>
+#include <QSortFilterProxyModel>
+#include <QTableView>
+#include <QVBoxLayout>
+#include "netinspector.h"
+
+NetTableModel::NetTableModel(SignalVisualizer* model, QObject* parent)
+    : QAbstractTableModel(parent), m_model(model) {
+    connect(m_model, &SignalVisualizer::modelChanged,
+    this, [this](SignalVisualizer::ChangeAspects aspects, const QSet<QString>& nets) {
+        onModelChanged(aspects, nets);
+    });
+    reload();
+}
+
+int NetTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : m_keys.size();
+}
+
+int NetTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant NetTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_keys.size()) return QVariant();
+
+    const QString& key = m_keys[index.row()];
+    if (role == KeyRole) return key;
+
+    auto net = m_model->m_netConnections.constFind(key);
+    if (net == m_model->m_netConnections.cend()) return QVariant();
+
+    const int column = index.column();
+    if (role == Qt::DecorationRole) {
+        if (column == DesignationColorColumn && net->designationColor.isValid()) return net->designationColor;
+        if (column == TypeColorColumn && net->typeColor.isValid()) return net->typeColor;
+        return QVariant();
+    }
+    if (role != Qt::DisplayRole && role != SortRole) return QVariant();
+
+    switch (column) {
+    case KeyColumn:          return key;
+    case DesignationColumn:  return net->designation;
+    case TypeColumn:         return net->type;
+    case PinCountColumn:     return net->pinList.size();
+    case SegmentCountColumn: return net->lineList.size();
+    case DesignationColorColumn:
+        return net->designationColor.isValid() ? net->designationColor.name() : QString();
+    case TypeColorColumn:
+        return net->typeColor.isValid() ? net->typeColor.name() : QString();
+    default:
+        return QVariant();
+    }
+}
+
+QVariant NetTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+
+    switch (section) {
+    case KeyColumn:              return tr("Цепь");
+    case DesignationColumn:      return tr("Обозначение");
+    case TypeColumn:             return tr("Тип");
+    case PinCountColumn:         return tr("Пины");
+    case SegmentCountColumn:     return tr("Сегменты");
+    case DesignationColorColumn: return tr("Цвет обозначения");
+    case TypeColorColumn:        return tr("Цвет типа");
+    default:                     return QVariant();
+    }
+}
+
+void NetTableModel::reload() {
+    beginResetModel();
+    m_keys.clear();
+    m_rows.clear();
+    m_keys.reserve(m_model->m_netConnections.size());
+    m_rows.reserve(m_model->m_netConnections.size());
+    for (auto it = m_model->m_netConnections.cbegin(); it != m_model->m_netConnections.cend(); ++it) {
+        m_rows.insert(it.key(), m_keys.size());
+        m_keys.append(it.key());
+    }
+    endResetModel();
+}
+
+void NetTableModel::onModelChanged(SignalVisualizer::ChangeAspects aspects, const QSet<QString>& nets) {
+    // Набор сетей меняется только при перестройке схемы
+    if (aspects & SignalVisualizer::GeometryChanged) {
+        reload();
+        return;
+    }
+    if (m_keys.isEmpty()) return;
+
+    // Крупную правку сообщаем одним диапазоном, чтобы прокси не пересортировывал по строке
+    if (nets.size() > 256) {
+        emit dataChanged(index(0, 0), index(m_keys.size() - 1, ColumnCount - 1));
+        return;
+    }
+    for (const QString& key : nets) {
+        const int row = m_rows.value(key, -1);
+        if (row < 0) continue;
+        emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+    }
+}
+
+NetInspector::NetInspector(SignalVisualizer* model, QWidget* parent) : QWidget(parent) {
+    m_tableModel = new NetTableModel(model, this);
+    m_proxy = new QSortFilterProxyModel(this);
+    m_proxy->setSourceModel(m_tableModel);
+    m_proxy->setSortRole(NetTableModel::SortRole);
+    m_proxy->setFilterKeyColumn(-1);
+    m_proxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
+
+    m_filterEdit = new QLineEdit(this);
+    m_filterEdit->setPlaceholderText(tr("Фильтр цепей..."));
+    m_filterEdit->setClearButtonEnabled(true);
+    connect(m_filterEdit, &QLineEdit::textChanged, m_proxy, &QSortFilterProxyModel::setFilterFixedString);
+
+    // Высота строк фиксирована, ширина колонок не подбирается по содержимому:
+    // представление не обходит все строки ради разметки
+    m_table = new QTableView(this);
+    m_table->setModel(m_proxy);
+    m_table->setSortingEnabled(true);
+    m_table->sortByColumn(NetTableModel::KeyColumn, Qt::AscendingOrder);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setWordWrap(false);
+    m_table->verticalHeader()->hide();
+    m_table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_table->verticalHeader()->setDefaultSectionSize(m_table->fontMetrics().height() + 6);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+
+    connect(m_table->selectionModel(), &QItemSelectionModel::selectionChanged,
+            this, &NetInspector::onSelectionChanged);
+    connect(m_table, &QTableView::doubleClicked, this, [this](const QModelIndex& index) {
+        emit netActivated(index.data(NetTableModel::KeyRole).toString());
+    });
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(m_filterEdit);
+    layout->addWidget(m_table);
+}
+
+void NetInspector::onSelectionChanged() {
+    QStringList keys;
+    for (const QModelIndex& index : m_table->selectionModel()->selectedRows(NetTableModel::KeyColumn)) {
+        keys.append(index.data(NetTableModel::KeyRole).toString());
+    }
+    emit netsSelected(keys);
+}
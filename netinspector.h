@@ -0,0 +1,75 @@
+#ifndef NETINSPECTOR_H
+#define NETINSPECTOR_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include <QWidget>
+#include "signalvisualizer.h"
+
+class QLineEdit;
+class QTableView;
+class QSortFilterProxyModel;
+
+// Таблица цепей поверх карты сетей модели, без копирования атрибутов.
+// Строки - ключи сетей; значения читаются из модели только для видимых ячеек,
+// при правках обновляются лишь строки изменённых сетей.
+class NetTableModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column {
+        KeyColumn,
+        DesignationColumn,
+        TypeColumn,
+        PinCountColumn,
+        SegmentCountColumn,
+        DesignationColorColumn,
+        TypeColorColumn,
+        ColumnCount
+    };
+
+    // Значение для сортировки: числа сравниваются как числа
+    static constexpr int SortRole = Qt::UserRole;
+    static constexpr int KeyRole = Qt::UserRole + 1;
+
+    explicit NetTableModel(SignalVisualizer* model, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    QString keyAt(int row) const { return m_keys.value(row); }
+
+    void reload();
+
+private:
+    void onModelChanged(SignalVisualizer::ChangeAspects aspects, const QSet<QString>& nets);
+
+    SignalVisualizer* m_model;
+    QVector<QString> m_keys;
+    QHash<QString, int> m_rows;
+};
+
+// Панель таблицы цепей с фильтром; выбор строк выделяет цепи на схеме
+class NetInspector : public QWidget {
+    Q_OBJECT
+public:
+    explicit NetInspector(SignalVisualizer* model, QWidget* parent = nullptr);
+
+signals:
+    void netsSelected(const QStringList& keys);
+    void netActivated(const QString& key);
+
+private:
+    void onSelectionChanged();
+
+    NetTableModel* m_tableModel;
+    QSortFilterProxyModel* m_proxy;
+    QLineEdit* m_filterEdit;
+    QTableView* m_table;
+};
+
+#endif // NETINSPECTOR_H
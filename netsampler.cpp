@@ -0,0 +1,365 @@
+#include "netsampler.h"
+#include "signalvisualizer.h"
+#include "simulator.h"
+#include "e-node.h"
+#include "pin.h"
+#include "vcdwriter.h"
+#include <algorithm>
+
+namespace {
+    enum LogicState {
+        LogicLow = 0,
+        LogicHigh = 1,
+        LogicUndefined = 2
+    };
+}
+
+void ToggleActivityRing::reset(int netCount, int windowCount) {
+    m_netCount = qMax(0, netCount);
+    m_windowCount = qMax(2, windowCount);
+    m_counts.reset(new std::atomic<quint32>[size_t(m_netCount) * m_windowCount]);
+
+    for (size_t i = 0; i < size_t(m_netCount) * m_windowCount; ++i) {
+        m_counts[i].store(0, std::memory_order_relaxed);
+    }
+    m_head.store(0, std::memory_order_release);
+}
+
+void ToggleActivityRing::recordToggle(int net) {
+    int head = m_head.load(std::memory_order_relaxed);
+    m_counts[size_t(head) * m_netCount + net].fetch_add(1, std::memory_order_relaxed);
+}
+
+void ToggleActivityRing::advanceWindow() {
+    int next = (m_head.load(std::memory_order_relaxed) + 1) % m_windowCount;
+    std::atomic<quint32>* slot = &m_counts[size_t(next) * m_netCount];
+
+    // Самое старое окно очищается и становится текущим
+    for (int i = 0; i < m_netCount; ++i) {
+        slot[i].store(0, std::memory_order_relaxed);
+    }
+    m_head.store(next, std::memory_order_release);
+}
+
+void ToggleActivityRing::readTotals(QVector<quint32>& totals) const {
+    totals.fill(0, m_netCount);
+    int head = m_head.load(std::memory_order_acquire);
+
+    for (int w = 0; w < m_windowCount; ++w) {
+        if (w == head) continue; // текущее окно ещё заполняется
+        const std::atomic<quint32>* slot = &m_counts[size_t(w) * m_netCount];
+        for (int i = 0; i < m_netCount; ++i) {
+            totals[i] += slot[i].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+NetActivityProbe::NetActivityProbe(Pin* pin, int index, NetSampler* sampler)
+    : eElement("SignalVisualizerProbe-" + QString::number(index)),
+      m_pin(pin), m_index(index), m_sampler(sampler) {
+}
+
+void NetActivityProbe::stamp() {
+    // Узлы пересоздаются при каждом запуске, подписка оформляется заново на новый узел
+    m_sampler->resetProbeState(m_index);
+    if (m_pin) m_pin->changeCallBack(this);
+}
+
+void NetActivityProbe::voltChanged() {
+    eNode* enode = m_pin ? m_pin->getEnode() : nullptr;
+    if (enode) m_sampler->recordVoltage(m_index, enode->getVolt());
+}
+
+void NetActivityProbe::detach() {
+    if (m_pin) m_pin->changeCallBack(this, false);
+}
+
+NetSampler::NetSampler(SignalVisualizer* model, QObject* parent)
+    : QObject(parent), m_model(model) {
+    setFrameRate(25);
+    connect(&m_frameTimer, &QTimer::timeout, this, &NetSampler::sampleFrame);
+}
+
+NetSampler::~NetSampler() {
+    detachSimulationProbes();
+}
+
+void NetSampler::start() {
+    m_overlayEnabled = true;
+    detachSimulationProbes();
+    rebuildProbes();
+    updateSampling();
+}
+
+void NetSampler::stop() {
+    m_overlayEnabled = false;
+    updateSampling();
+}
+
+bool NetSampler::startCapture(const QString& fileName, QString* error) {
+    stopCapture();
+    if (m_probes.isEmpty()) rebuildProbes();
+
+    // В VCD попадают только цепи, которым классификация присвоила обозначение
+    QStringList names;
+    m_captureSignals.clear();
+    for (const NetProbe& probe : m_probes) {
+        const SignalVisualizer::NetConnections& net = m_model->m_netConnections.value(probe.key);
+        if (net.designation.isEmpty() || net.type == "Power") continue;
+
+        m_captureSignals.insert(probe.key, names.size());
+        names.append(net.designation);
+    }
+
+    std::unique_ptr<VcdWriter> vcd(new VcdWriter());
+    if (!vcd->open(fileName, names)) {
+        if (error) *error = vcd->errorString();
+        m_captureSignals.clear();
+        return false;
+    }
+
+    detachSimulationProbes();
+    m_vcd = std::move(vcd);
+    updateSampling();
+    return true;
+}
+
+bool NetSampler::stopCapture(QString* error) {
+    if (!m_vcd) return true;
+
+    // Пробники отключаются до закрытия файла, после этого поток симуляции в него не пишет
+    detachSimulationProbes();
+    const bool written = m_vcd->close();
+    if (!written && error) *error = m_vcd->errorString();
+    m_vcd.reset();
+    m_captureSignals.clear();
+    updateSampling();
+    return written;
+}
+
+void NetSampler::updateSampling() {
+    const bool countToggles = m_overlayEnabled && m_mode == Mode::Heatmap;
+    m_countToggles.store(countToggles);
+
+    if (countToggles || m_vcd) attachSimulationProbes();
+    else detachSimulationProbes();
+
+    if (m_overlayEnabled || m_vcd) {
+        if (!m_frameTimer.isActive()) m_frameTimer.start();
+    } else {
+        m_frameTimer.stop();
+        m_probes.clear();
+    }
+}
+
+void NetSampler::setMode(Mode mode) {
+    if (m_mode == mode) return;
+    m_mode = mode;
+
+    // Сбрасываем состояния, чтобы следующий кадр перекрасил все цепи
+    for (NetProbe& probe : m_probes) {
+        probe.state = -1;
+    }
+
+    updateSampling();
+}
+
+void NetSampler::setFrameRate(int fps) {
+    m_frameTimer.setInterval(1000 / qBound(1, fps, 60));
+}
+
+void NetSampler::setLogicThresholds(double low, double high) {
+    m_lowThreshold = qMin(low, high);
+    m_highThreshold = qMax(low, high);
+}
+
+void NetSampler::setVoltageRange(double maxVoltage) {
+    if (maxVoltage > 0) m_maxVoltage = maxVoltage;
+}
+
+void NetSampler::setHeatmapWindow(int windowMs, int windowCount) {
+    // Применяется при следующем запуске записи
+    m_windowMs = qMax(1, windowMs);
+    m_windowCount = qMax(2, windowCount);
+}
+
+void NetSampler::rebuildProbes() {
+    m_probes.clear();
+    m_probes.reserve(m_model->m_netConnections.size());
+
+    for (auto it = m_model->m_netConnections.cbegin(); it != m_model->m_netConnections.cend(); ++it) {
+        for (Pin* pin : it.value().pinList) {
+            if (!pin) continue;
+
+            NetProbe probe;
+            probe.key = it.key();
+            probe.pin = pin;
+            m_probes.append(probe);
+            break;
+        }
+    }
+}
+
+void NetSampler::sampleFrame() {
+    bool running = Simulator::self() && Simulator::self()->isRunning();
+    if (!m_overlayEnabled || !running) return;
+
+    if (m_mode == Mode::Heatmap) {
+        advanceActivityWindow();
+        sampleHeatmap();
+        return;
+    }
+
+    QHash<QString, QColor> changed;
+
+    for (NetProbe& probe : m_probes) {
+        if (!probe.pin) continue;
+
+        // Узел цепи пересоздаётся симулятором при перезапуске, поэтому берём его на каждом кадре
+        eNode* enode = probe.pin->getEnode();
+        if (!enode) continue;
+
+        int state = quantize(enode->getVolt(), probe.state);
+        if (state == probe.state) continue;
+
+        probe.state = state;
+        changed.insert(probe.key, stateColor(state));
+    }
+
+    if (!changed.isEmpty()) {
+        emit netsChanged(changed);
+    }
+}
+
+void NetSampler::attachSimulationProbes() {
+    if (!m_simProbes.empty()) return;
+
+    const int count = m_probes.size();
+    m_activity.reset(count, m_windowCount);
+    m_probeStates.reset(new quint8[count]);
+    m_captureIndex.reset(new int[count]);
+    for (int i = 0; i < count; ++i) {
+        m_probeStates[i] = LogicUndefined;
+        m_captureIndex[i] = m_captureSignals.value(m_probes[i].key, -1);
+    }
+    m_totals.fill(0, count);
+    m_probeLow = m_lowThreshold;
+    m_probeHigh = m_highThreshold;
+    m_probeVcd = m_vcd.get();
+
+    // Список элементов и подписки узлов меняются только при стоящем потоке симуляции
+    Simulator* simulator = Simulator::self();
+    const bool running = simulator->isRunning();
+    if (running) simulator->pauseSim();
+
+    m_simProbes.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        if (!m_probes[i].pin) continue;
+
+        std::unique_ptr<NetActivityProbe> probe(new NetActivityProbe(m_probes[i].pin, i, this));
+        simulator->addToElementList(probe.get());
+        // Остановленная симуляция подпишет пробник сама при следующем запуске
+        if (running) probe->stamp();
+        m_simProbes.push_back(std::move(probe));
+    }
+
+    if (running) simulator->resumeSim();
+    m_windowTimer.start();
+}
+
+void NetSampler::detachSimulationProbes() {
+    if (m_simProbes.empty()) return;
+
+    Simulator* simulator = Simulator::self();
+    const bool running = simulator->isRunning();
+    if (running) simulator->pauseSim();
+
+    for (const auto& probe : m_simProbes) {
+        probe->detach();
+        simulator->remFromElementList(probe.get());
+    }
+    m_simProbes.clear();
+    m_probeVcd = nullptr;
+
+    if (running) simulator->resumeSim();
+}
+
+void NetSampler::resetProbeState(int index) {
+    m_probeStates[index] = LogicUndefined;
+}
+
+void NetSampler::recordVoltage(int index, double volt) {
+    // Вызывается потоком симуляции на каждое изменение напряжения узла
+    const quint8 state = m_probeStates[index];
+    const quint8 newState = (volt >= m_probeHigh) ? LogicHigh : (volt <= m_probeLow) ? LogicLow : state;
+    if (newState == state) return;
+
+    if (state != LogicUndefined && m_countToggles.load(std::memory_order_relaxed)) {
+        m_activity.recordToggle(index);
+    }
+    m_probeStates[index] = newState;
+
+    if (m_probeVcd && m_captureIndex[index] >= 0) {
+        m_probeVcd->record(Simulator::self()->circTime(), m_captureIndex[index], newState == LogicHigh ? '1' : '0');
+    }
+}
+
+void NetSampler::advanceActivityWindow() {
+    // Окна отсчитываются по реальному времени, счётчики в них - по событиям симуляции
+    if (!m_windowTimer.isValid() || m_windowTimer.elapsed() < m_windowMs) return;
+    m_activity.advanceWindow();
+    m_windowTimer.restart();
+}
+
+void NetSampler::sampleHeatmap() {
+    m_activity.readTotals(m_totals);
+    if (m_totals.isEmpty()) return;
+
+    const quint32 maxCount = *std::max_element(m_totals.cbegin(), m_totals.cend());
+    QHash<QString, QColor> changed;
+
+    for (int i = 0; i < m_probes.size(); ++i) {
+        NetProbe& probe = m_probes[i];
+        int state = 0;
+        if (maxCount > 0 && m_totals[i] > 0) {
+            state = 1 + qRound(double(m_totals[i]) / maxCount * (m_voltageLevels - 1));
+        }
+        if (state == probe.state) continue;
+
+        probe.state = state;
+        changed.insert(probe.key, stateColor(state));
+    }
+
+    if (!changed.isEmpty()) {
+        emit netsChanged(changed);
+    }
+}
+
+int NetSampler::quantize(double volt, int previousState) const {
+    if (m_mode == Mode::Voltage) {
+        double t = qBound(0.0, volt / m_maxVoltage, 1.0);
+        return qRound(t * (m_voltageLevels - 1));
+    }
+
+    // Гистерезис: между порогами сохраняем предыдущий логический уровень
+    if (volt >= m_highThreshold) return LogicHigh;
+    if (volt <= m_lowThreshold) return LogicLow;
+    return (previousState == LogicLow || previousState == LogicHigh) ? previousState : LogicUndefined;
+}
+
+QColor NetSampler::stateColor(int state) const {
+    if (m_mode == Mode::Voltage) {
+        return SignalVisualizer::voltageGradientColor(double(state) / (m_voltageLevels - 1));
+    }
+    if (m_mode == Mode::Heatmap) {
+        // Неактивные цепи серые, остальные по шкале от редких к частым переключениям
+        if (state <= 0) return Qt::gray;
+        return SignalVisualizer::voltageGradientColor(double(state - 1) / (m_voltageLevels - 1));
+    }
+
+    switch (state) {
+    case LogicHigh: return Qt::red;
+    case LogicLow:  return Qt::blue;
+    default:        return Qt::gray;
+    }
+}
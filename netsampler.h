@@ -0,0 +1,155 @@
+#ifndef NETSAMPLER_H
+#define NETSAMPLER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QHash>
+#include <QColor>
+#include <QPointer>
+#include <QVector>
+#include <QElapsedTimer>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "e-element.h"
+
+class SignalVisualizer;
+class Pin;
+class VcdWriter;
+class NetSampler;
+
+// Кольцевой буфер счётчиков переключений цепей по временным окнам.
+// Память выделяется один раз в reset(); счётчики пишет поток симуляции,
+// окна переключает и читает GUI-поток, без блокировок.
+class ToggleActivityRing {
+public:
+    void reset(int netCount, int windowCount);
+
+    // Поток симуляции
+    void recordToggle(int net);
+
+    // GUI-поток: текущее окно закрывается, самое старое очищается
+    void advanceWindow();
+
+    // GUI-поток: сумма по всем завершённым окнам
+    void readTotals(QVector<quint32>& totals) const;
+
+    int netCount() const { return m_netCount; }
+
+private:
+    std::unique_ptr<std::atomic<quint32>[]> m_counts;
+    std::atomic<int> m_head{0};
+    int m_netCount = 0;
+    int m_windowCount = 0;
+};
+
+// Пробник цепи на стороне симуляции. Симулятор вызывает voltChanged из своего потока
+// при каждом изменении напряжения узла, поэтому переключения не теряются между кадрами,
+// а узел читается только пока он заведомо жив.
+class NetActivityProbe : public eElement {
+public:
+    NetActivityProbe(Pin* pin, int index, NetSampler* sampler);
+
+    void stamp() override;
+    void voltChanged() override;
+
+    // Снять подписку с текущего узла; вызывается при остановленной или приостановленной симуляции
+    void detach();
+
+private:
+    QPointer<Pin> m_pin;
+    int m_index;
+    NetSampler* m_sampler;
+};
+
+// Опрос напряжений цепей работающей симуляции с фиксированной частотой кадров.
+// Тепловая карта и запись VCD получают переключения от пробников на стороне симуляции.
+class NetSampler : public QObject {
+    Q_OBJECT
+public:
+    enum class Mode {
+        Voltage,
+        Logic,
+        Heatmap
+    };
+
+    explicit NetSampler(SignalVisualizer* model, QObject* parent = nullptr);
+    ~NetSampler();
+
+    void start();
+    void stop();
+    bool isActive() const { return m_overlayEnabled; }
+
+    bool startCapture(const QString& fileName, QString* error = nullptr);
+    // false и текст ошибки, если файл записан не полностью
+    bool stopCapture(QString* error = nullptr);
+    bool isCapturing() const { return m_vcd != nullptr; }
+
+    void setMode(Mode mode);
+    Mode mode() const { return m_mode; }
+    void setFrameRate(int fps);
+    void setLogicThresholds(double low, double high);
+    void setVoltageRange(double maxVoltage);
+    void setHeatmapWindow(int windowMs, int windowCount);
+
+signals:
+    // Один пакет изменений цвета за кадр
+    void netsChanged(const QHash<QString, QColor>& colors);
+
+private slots:
+    void sampleFrame();
+
+private:
+    friend class NetActivityProbe;
+
+    struct NetProbe {
+        QString key;
+        QPointer<Pin> pin;
+        int state = -1;
+    };
+
+    void rebuildProbes();
+    int quantize(double volt, int previousState) const;
+    QColor stateColor(int state) const;
+
+    void updateSampling();
+    void attachSimulationProbes();
+    void detachSimulationProbes();
+    void advanceActivityWindow();
+    void sampleHeatmap();
+
+    // Поток симуляции
+    void recordVoltage(int index, double volt);
+    void resetProbeState(int index);
+
+    SignalVisualizer* m_model;
+    QTimer m_frameTimer;
+    QVector<NetProbe> m_probes;
+
+    Mode m_mode = Mode::Logic;
+    bool m_overlayEnabled = false;
+    double m_lowThreshold = 0.8;
+    double m_highThreshold = 2.0;
+    double m_maxVoltage = 5.0;
+    const int m_voltageLevels = 16;
+
+    // Счётчики переключений для тепловой карты
+    ToggleActivityRing m_activity;
+    std::vector<std::unique_ptr<NetActivityProbe>> m_simProbes;
+    std::unique_ptr<quint8[]> m_probeStates;
+    double m_probeLow = 0.8;
+    double m_probeHigh = 2.0;
+    QVector<quint32> m_totals;
+    std::atomic_bool m_countToggles{false};
+    QElapsedTimer m_windowTimer;
+    int m_windowMs = 100;
+    int m_windowCount = 20;
+
+    // Запись переключений именованных цепей в VCD, с точностью шага симуляции
+    std::unique_ptr<VcdWriter> m_vcd;
+    VcdWriter* m_probeVcd = nullptr;
+    QHash<QString, int> m_captureSignals;
+    std::unique_ptr<int[]> m_captureIndex;
+};
+
+#endif // NETSAMPLER_H
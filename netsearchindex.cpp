@@ -0,0 +1,159 @@
+#include "netsearchindex.h"
+#include <algorithm>
+
+void NetSearchIndex::clear() {
+    m_docs.clear();
+    m_freeIds.clear();
+    m_docIds.clear();
+    m_terms.clear();
+    m_trigrams.clear();
+}
+
+void NetSearchIndex::updateNet(const QString& key, const QStringList& terms, const QRectF& bounds) {
+    int id = m_docIds.value(key, -1);
+    if (id >= 0) {
+        unindexDocument(id);
+    } else if (!m_freeIds.isEmpty()) {
+        id = m_freeIds.takeLast();
+        m_docIds.insert(key, id);
+    } else {
+        id = m_docs.size();
+        m_docs.append(Document());
+        m_docIds.insert(key, id);
+    }
+
+    Document& doc = m_docs[id];
+    doc.key = key;
+    doc.terms.clear();
+    doc.display.clear();
+    doc.bounds = bounds;
+    for (const QString& term : terms) {
+        const QString trimmed = term.trimmed();
+        const QString lower = trimmed.toLower();
+        if (lower.isEmpty() || doc.terms.contains(lower)) continue;
+
+        doc.terms.append(lower);
+        doc.display.append(trimmed);
+    }
+
+    indexDocument(id);
+}
+
+void NetSearchIndex::removeNet(const QString& key) {
+    auto it = m_docIds.find(key);
+    if (it == m_docIds.end()) return;
+
+    const int id = it.value();
+    unindexDocument(id);
+    m_docs[id] = Document();
+    m_freeIds.append(id);
+    m_docIds.erase(it);
+}
+
+QRectF NetSearchIndex::bounds(const QString& key) const {
+    const int id = m_docIds.value(key, -1);
+    return id >= 0 ? m_docs[id].bounds : QRectF();
+}
+
+quint64 NetSearchIndex::trigram(const QString& text, int pos) {
+    return (quint64(text[pos].unicode()) << 32)
+         | (quint64(text[pos + 1].unicode()) << 16)
+         |  quint64(text[pos + 2].unicode());
+}
+
+void NetSearchIndex::indexDocument(int id) {
+    for (const QString& term : m_docs[id].terms) {
+        m_terms[term].insert(id);
+        for (int i = 0; i + 3 <= term.size(); ++i) {
+            m_trigrams[trigram(term, i)].insert(id);
+        }
+    }
+}
+
+void NetSearchIndex::unindexDocument(int id) {
+    for (const QString& term : m_docs[id].terms) {
+        auto docs = m_terms.find(term);
+        if (docs != m_terms.end()) {
+            docs->remove(id);
+            if (docs->isEmpty()) m_terms.erase(docs);
+        }
+
+        for (int i = 0; i + 3 <= term.size(); ++i) {
+            auto posting = m_trigrams.find(trigram(term, i));
+            if (posting == m_trigrams.end()) continue;
+            posting->remove(id);
+            if (posting->isEmpty()) m_trigrams.erase(posting);
+        }
+    }
+}
+
+bool NetSearchIndex::matchDocument(int id, const QString& query, Match& match) const {
+    const Document& doc = m_docs[id];
+    match.rank = 3;
+    for (int i = 0; i < doc.terms.size(); ++i) {
+        const QString& term = doc.terms[i];
+        int rank = term == query ? 0 : term.startsWith(query) ? 1 : term.contains(query) ? 2 : 3;
+        if (rank < match.rank || (rank == match.rank && doc.display[i].size() < match.term.size())) {
+            match.rank = rank;
+            match.term = doc.display[i];
+        }
+    }
+    if (match.rank > 2) return false;
+
+    match.key = doc.key;
+    match.bounds = doc.bounds;
+    return true;
+}
+
+QVector<NetSearchIndex::Match> NetSearchIndex::search(const QString& query, int limit) const {
+    QVector<Match> result;
+    const QString q = query.trimmed().toLower();
+    if (q.isEmpty() || limit <= 0) return result;
+
+    QSet<int> candidates;
+    if (q.size() < 3) {
+        // Триграмм нет, поэтому только префиксы терминов
+        for (auto it = m_terms.lowerBound(q); it != m_terms.cend() && it.key().startsWith(q); ++it) {
+            candidates.unite(it.value());
+        }
+    } else {
+        QVector<const QSet<int>*> postings;
+        for (int i = 0; i + 3 <= q.size(); ++i) {
+            auto posting = m_trigrams.constFind(trigram(q, i));
+            if (posting == m_trigrams.cend()) return result;
+            postings.append(&posting.value());
+        }
+
+        // Пересечение начинается с самого короткого списка
+        std::sort(postings.begin(), postings.end(), [](const QSet<int>* a, const QSet<int>* b) {
+            return a->size() < b->size();
+        });
+        for (int id : *postings.first()) {
+            bool inAll = true;
+            for (int i = 1; i < postings.size() && inAll; ++i) {
+                inAll = postings[i]->contains(id);
+            }
+            if (inAll) candidates.insert(id);
+        }
+    }
+
+    result.reserve(candidates.size());
+    for (int id : candidates) {
+        // Триграммы могут совпасть в разных терминах, подстрока проверяется явно
+        Match match;
+        if (matchDocument(id, q, match)) result.append(match);
+    }
+
+    auto byRelevance = [](const Match& a, const Match& b) {
+        if (a.rank != b.rank) return a.rank < b.rank;
+        if (a.term.size() != b.term.size()) return a.term.size() < b.term.size();
+        return a.key < b.key;
+    };
+    if (result.size() > limit) {
+        std::partial_sort(result.begin(), result.begin() + limit, result.end(), byRelevance);
+        result.resize(limit);
+    } else {
+        std::sort(result.begin(), result.end(), byRelevance);
+    }
+    return result;
+}
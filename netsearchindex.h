@@ -0,0 +1,56 @@
+#ifndef NETSEARCHINDEX_H
+#define NETSEARCHINDEX_H
+
+#include <QHash>
+#include <QMap>
+#include <QRectF>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Поисковый индекс цепей по обозначениям, типам, пинам и компонентам.
+// Короткие запросы ищутся по префиксу в упорядоченном словаре терминов,
+// запросы от трёх символов - по пересечению списков триграмм с проверкой подстроки.
+// Цепи добавляются, обновляются и удаляются по одной, без перестройки всего индекса.
+class NetSearchIndex {
+public:
+    struct Match {
+        QString key;
+        QString term;   // термин, на котором сработало совпадение
+        QRectF bounds;
+        int rank = 0;   // 0 - точное, 1 - по префиксу, 2 - по подстроке
+    };
+
+    void clear();
+    void updateNet(const QString& key, const QStringList& terms, const QRectF& bounds);
+    void removeNet(const QString& key);
+
+    bool contains(const QString& key) const { return m_docIds.contains(key); }
+    QRectF bounds(const QString& key) const;
+    int size() const { return m_docIds.size(); }
+
+    QVector<Match> search(const QString& query, int limit = 50) const;
+
+private:
+    struct Document {
+        QString key;
+        QStringList terms;      // в нижнем регистре, без повторов
+        QStringList display;    // в исходном виде, для вывода
+        QRectF bounds;
+    };
+
+    static quint64 trigram(const QString& text, int pos);
+    void indexDocument(int id);
+    void unindexDocument(int id);
+    bool matchDocument(int id, const QString& query, Match& match) const;
+
+    QVector<Document> m_docs;
+    QVector<int> m_freeIds;
+    QHash<QString, int> m_docIds;
+
+    QMap<QString, QSet<int>> m_terms;
+    QHash<quint64, QSet<int>> m_trigrams;
+};
+
+#endif // NETSEARCHINDEX_H
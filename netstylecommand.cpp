@@ -0,0 +1,24 @@
+#include "netstylecommand.h"
+
+NetStyleCommand::NetStyleCommand(SignalVisualizer* model, const QList<SignalVisualizer::NetStyleChange>& changes,
+                                 const QString& text, QUndoCommand* parent)
+    : QUndoCommand(text, parent), m_model(model) {
+    m_before.reserve(changes.size());
+    m_after.reserve(changes.size());
+    for (const SignalVisualizer::NetStyleChange& change : changes) {
+        m_before.append({change.key, change.before});
+        m_after.append({change.key, change.after});
+    }
+}
+
+void NetStyleCommand::undo() {
+    m_model->applyNetStyles(m_before);
+    m_applied = false;
+}
+
+void NetStyleCommand::redo() {
+    // Правка уже применена к модели в момент добавления команды в стек
+    if (m_applied) return;
+    m_model->applyNetStyles(m_after);
+    m_applied = true;
+}
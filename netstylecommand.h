@@ -0,0 +1,24 @@
+#ifndef NETSTYLECOMMAND_H
+#define NETSTYLECOMMAND_H
+
+#include <QUndoCommand>
+#include "signalvisualizer.h"
+
+// Отменяемая правка оформления цепей.
+// Хранит только состояния затронутых сетей до и после правки.
+class NetStyleCommand : public QUndoCommand {
+public:
+    NetStyleCommand(SignalVisualizer* model, const QList<SignalVisualizer::NetStyleChange>& changes,
+                    const QString& text, QUndoCommand* parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+
+private:
+    SignalVisualizer* m_model;
+    QList<SignalVisualizer::ConfigUpdate> m_before;
+    QList<SignalVisualizer::ConfigUpdate> m_after;
+    bool m_applied = true;
+};
+
+#endif // NETSTYLECOMMAND_H
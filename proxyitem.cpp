@@ -2,6 +2,7 @@
 #include <QPainter>
 #include <QGraphicsSimpleTextItem>
 #include <unordered_set>
+#include <algorithm>
 #include "proxyitem.h"
 #include "pin.h"
 #include "mcu.h"
@@ -32,10 +33,6 @@ MainComponentProxyItem::MainComponentProxyItem(Component* comp, SignalVisualizer
     if (m_component->itemType() != "KeyPad") {
         setTransform(QTransform::fromScale(comp->hflip(), comp->vflip()));
     }
-
-    if (m_component->itemType() != "Subcircuit") {
-        createPinItems();
-    }
 }
 
 QRectF MainComponentProxyItem::boundingRect() const {
@@ -61,32 +58,62 @@ QGraphicsSimpleTextItem* MainComponentProxyItem::copyLabelItem(QGraphicsSimpleTe
     return copy;
 }
 
+int MainComponentProxyItem::materializePinItems() {
+    if (m_materialized) return m_materializedCost;
+    m_materialized = true;
+
+    if (m_component->itemType() != "Subcircuit") {
+        createPinItems();
+    }
+    m_materializedCost = static_cast<int>(m_pinItems.size()) + m_labelCopies.size();
+    return m_materializedCost;
+}
+
+int MainComponentProxyItem::releasePinItems() {
+    if (!m_materialized) return 0;
+
+    // Обработчик destroyed удаляет пин из m_pinItems, поэтому обходится отдельная копия
+    std::vector<PinProxyItem*> pinItems;
+    pinItems.swap(m_pinItems);
+    for (PinProxyItem* pinItem : pinItems) {
+        delete pinItem;
+    }
+    qDeleteAll(m_labelCopies);
+    m_labelCopies.clear();
+
+    int released = m_materializedCost;
+    m_materializedCost = 0;
+    m_materialized = false;
+    return released;
+}
+
+void MainComponentProxyItem::addPinItem(Pin* pin, bool raiseLabel) {
+    auto* pinItem = new PinProxyItem(pin);
+    pinItem->setParentItem(this);
+    m_pinItems.push_back(pinItem);
+
+    // Прокси пина может быть удалён вместе с пином схемы
+    connect(pinItem, &QObject::destroyed, this, [this, pinItem]() {
+        m_pinItems.erase(std::remove(m_pinItems.begin(), m_pinItems.end(), pinItem), m_pinItems.end());
+    });
+
+    if (QGraphicsSimpleTextItem* origLabel = pin->getLabelItem()) {
+        QGraphicsSimpleTextItem* labelCopy = copyLabelItem(origLabel, this);
+        if (raiseLabel) labelCopy->setZValue(500);
+        m_labelCopies.append(labelCopy);
+    }
+}
+
 void MainComponentProxyItem::createPinItems() {
     for (Pin* pin : m_component->getPins()) {
         if (!pin) continue;
-        
-        auto* pinItem = new PinProxyItem(pin);
-        pinItem->setParentItem(this);
-        m_pinItems.push_back(pinItem);
-
-        QGraphicsSimpleTextItem* origLabel = pin->getLabelItem();
-        if (origLabel) {
-            m_labelCopy = copyLabelItem(origLabel, this);
-        }
+        addPinItem(pin, false);
     }
     Mcu* mcu = dynamic_cast<Mcu*>(m_component);
     if (mcu) {
         for (Pin* pin : mcu->getPinList()) {
             if (!pin) continue;
-
-            auto* pinItem = new PinProxyItem(pin);
-            pinItem->setParentItem(this);
-            m_pinItems.push_back(pinItem);
-
-            if (QGraphicsSimpleTextItem* origLabel = pin->getLabelItem()) {
-                QGraphicsSimpleTextItem* labelCopy = copyLabelItem(origLabel, this);
-                labelCopy->setZValue(500);
-            }
+            addPinItem(pin, true);
         }
     }
     IoComponent* ioComp = dynamic_cast<IoComponent*>(m_component);
@@ -109,15 +136,7 @@ void MainComponentProxyItem::createPinItems() {
 
         for (IoPin* pin : combinedPins) {
             if (!pin) continue;
-
-            auto* pinItem = new PinProxyItem(pin);
-            pinItem->setParentItem(this);
-            m_pinItems.push_back(pinItem);
-
-            if (QGraphicsSimpleTextItem* origLabel = pin->getLabelItem()) {
-                QGraphicsSimpleTextItem* labelCopy = copyLabelItem(origLabel, this);
-                labelCopy->setZValue(500);
-            }
+            addPinItem(pin, true);
         }
     }
 }
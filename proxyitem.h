@@ -25,8 +25,16 @@ public:
     QRectF boundingRect() const override;
     void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
 
+    // Пины и подписи пинов создаются только при первом попадании в область видимости
+    bool isMaterialized() const { return m_materialized; }
+    Component* component() const { return m_component; }
+    int materializedCost() const { return m_materializedCost; }
+    int materializePinItems();
+    int releasePinItems();
+
 private:
     void createPinItems();
+    void addPinItem(Pin* pin, bool raiseLabel);
     QGraphicsSimpleTextItem* copyLabelItem(QGraphicsSimpleTextItem* origLabel, QGraphicsItem* parent = nullptr);
 
     QString m_id;
@@ -34,8 +42,10 @@ private:
     SignalVisualizerView* m_visualizerView;
     QList<QGraphicsTextItem*> m_labelItems;
     QList<QGraphicsTextItem*> m_textItems;
-    QGraphicsSimpleTextItem* m_labelCopy = nullptr;
+    QList<QGraphicsSimpleTextItem*> m_labelCopies;
     std::vector<PinProxyItem*> m_pinItems;
+    bool m_materialized = false;
+    int m_materializedCost = 0;
 };
 
 class PinProxyItem : public QObject, public QGraphicsItem {
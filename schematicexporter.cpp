@@ -0,0 +1,193 @@
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QPdfWriter>
+#include <QPicture>
+#include <QSvgGenerator>
+#include <QThread>
+#include <QtConcurrent>
+#include <QtMath>
+#include "schematicexporter.h"
+
+namespace {
+    // Единицы сцены соответствуют пикселям экрана 96 dpi
+    constexpr qreal SceneDpi = 96.0;
+    constexpr qreal DocumentMargin = 20.0;
+}
+
+bool SchematicExporter::exportToFile(SignalVisualizerView* view, const QString& fileName,
+                                     const Options& options, QString* error) {
+    if (!view || !view->scene() || view->scene()->itemsBoundingRect().isEmpty()) {
+        if (error) *error = QObject::tr("Схема пуста");
+        return false;
+    }
+
+    const QString suffix = QFileInfo(fileName).suffix().toLower();
+    if (suffix == "svg") return exportSvg(view, fileName, options, error);
+    if (suffix == "pdf") return exportPdf(view, fileName, options, error);
+    return exportRaster(view, fileName, options, error);
+}
+
+SchematicExporter::DocumentLayout SchematicExporter::layoutDocument(SignalVisualizerView* view, const Options& options) {
+    DocumentLayout layout;
+    layout.source = view->scene()->itemsBoundingRect();
+    layout.sceneTarget = QRectF(QPointF(DocumentMargin, DocumentMargin), layout.source.size());
+
+    QSizeF size = layout.sceneTarget.size();
+    if (options.includeLegend && !view->m_legendItems.isEmpty()) {
+        // Легенда справа от схемы, чтобы не закрывать проводники
+        layout.legend = LegendWidget::computeLayout(view->m_legendItems, view->m_legendOverlay->font());
+        layout.legendOrigin = QPointF(layout.sceneTarget.right() + DocumentMargin, DocumentMargin);
+        size = QSizeF(size.width() + DocumentMargin + layout.legend.size.width(),
+                      qMax(size.height(), layout.legend.size.height()));
+    }
+    layout.size = size + QSizeF(2 * DocumentMargin, 2 * DocumentMargin);
+    return layout;
+}
+
+void SchematicExporter::renderDocument(SignalVisualizerView* view, QPainter* painter, const DocumentLayout& layout) {
+    painter->fillRect(QRectF(QPointF(0, 0), layout.size), Qt::white);
+    view->renderSceneForExport(painter, layout.sceneTarget, layout.source);
+
+    if (!layout.legend.size.isEmpty()) {
+        // Легенда рисуется тем же кодом, что и в окне просмотра
+        painter->setFont(view->m_legendOverlay->font());
+        LegendWidget::paintLegend(painter, layout.legendOrigin, layout.legend, view->m_legendItems);
+    }
+}
+
+bool SchematicExporter::exportRaster(SignalVisualizerView* view, const QString& fileName,
+                                     const Options& options, QString* error) {
+    const DocumentLayout layout = layoutDocument(view, options);
+    const qreal scale = qBound(24, options.dpi, 2400) / SceneDpi;
+    const QSize imageSize(qCeil(layout.size.width() * scale), qCeil(layout.size.height() * scale));
+
+    if (qint64(imageSize.width()) * imageSize.height() > options.maxRasterPixels) {
+        if (error) *error = QObject::tr("Изображение %1x%2 слишком велико для PNG, используйте PDF или уменьшите разрешение")
+                                .arg(imageSize.width()).arg(imageSize.height());
+        return false;
+    }
+
+    // Сцена записывается один раз в GUI-потоке, плитки воспроизводят запись параллельно
+    QPicture picture;
+    QPainter recorder(&picture);
+    renderDocument(view, &recorder, layout);
+    recorder.end();
+    const QByteArray commands(picture.data(), int(picture.size()));
+
+    QImage image(imageSize, QImage::Format_RGB32);
+    if (image.isNull()) {
+        if (error) *error = QObject::tr("Недостаточно памяти для изображения %1x%2")
+                                .arg(imageSize.width()).arg(imageSize.height());
+        return false;
+    }
+
+    const int tileSize = qMax(256, options.tileSize);
+    QList<QRect> tiles;
+    for (int y = 0; y < imageSize.height(); y += tileSize) {
+        for (int x = 0; x < imageSize.width(); x += tileSize) {
+            tiles.append(QRect(x, y, qMin(tileSize, imageSize.width() - x), qMin(tileSize, imageSize.height() - y)));
+        }
+    }
+
+    // Плитки обрабатываются партиями, чтобы в памяти было не больше пары плиток на поток
+    const int batch = qMax(1, QThread::idealThreadCount()) * 2;
+    QPainter stitcher(&image);
+    for (int first = 0; first < tiles.size(); first += batch) {
+        const int last = qMin(first + batch, tiles.size());
+
+        QList<QFuture<QImage>> futures;
+        for (int i = first; i < last; ++i) {
+            futures.append(QtConcurrent::run(&SchematicExporter::renderTile, commands, tiles[i], scale));
+        }
+        for (int i = first; i < last; ++i) {
+            stitcher.drawImage(tiles[i].topLeft(), futures[i - first].result());
+        }
+    }
+    stitcher.end();
+
+    const int dotsPerMeter = qRound(options.dpi / 0.0254);
+    image.setDotsPerMeterX(dotsPerMeter);
+    image.setDotsPerMeterY(dotsPerMeter);
+
+    QImageWriter writer(fileName);
+    if (!writer.write(image)) {
+        if (error) *error = writer.errorString();
+        return false;
+    }
+    return true;
+}
+
+QImage SchematicExporter::renderTile(const QByteArray& commands, const QRect& tile, qreal scale) {
+    // Воспроизведение QPicture сдвигает позицию в его буфере, поэтому у каждой плитки своя копия
+    QPicture picture;
+    picture.setData(commands.constData(), uint(commands.size()));
+
+    QImage image(tile.size(), QImage::Format_RGB32);
+    image.fill(Qt::white);
+
+    QPainter painter(&image);
+    painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::SmoothPixmapTransform);
+    painter.translate(-tile.topLeft());
+    painter.scale(scale, scale);
+    painter.drawPicture(0, 0, picture);
+    painter.end();
+    return image;
+}
+
+bool SchematicExporter::exportSvg(SignalVisualizerView* view, const QString& fileName,
+                                  const Options& options, QString* error) {
+    const int itemCount = view->scene()->items().size();
+    if (itemCount > options.maxSvgItems) {
+        if (error) *error = QObject::tr("Схема из %1 элементов слишком велика для SVG, используйте PDF")
+                                .arg(itemCount);
+        return false;
+    }
+
+    const DocumentLayout layout = layoutDocument(view, options);
+
+    QSvgGenerator generator;
+    generator.setFileName(fileName);
+    generator.setSize(layout.size.toSize());
+    generator.setViewBox(QRectF(QPointF(0, 0), layout.size));
+    generator.setResolution(int(SceneDpi));
+    generator.setTitle(QFileInfo(fileName).completeBaseName());
+
+    // Текст документа копится в памяти генератора и попадает в файл только в painter.end()
+    QPainter painter;
+    if (!painter.begin(&generator)) {
+        if (error) *error = QObject::tr("Не удалось открыть файл для записи");
+        return false;
+    }
+    renderDocument(view, &painter, layout);
+    return painter.end();
+}
+
+bool SchematicExporter::exportPdf(SignalVisualizerView* view, const QString& fileName,
+                                  const Options& options, QString* error) {
+    const DocumentLayout layout = layoutDocument(view, options);
+
+    QPdfWriter pdf(fileName);
+    pdf.setResolution(qBound(24, options.dpi, 2400));
+    pdf.setCreator(QObject::tr("Визуализация сигналов"));
+    if (options.pageSize == QPageSize::Custom) {
+        pdf.setPageSize(QPageSize(layout.size * 72.0 / SceneDpi, QPageSize::Point));
+    } else {
+        pdf.setPageSize(QPageSize(options.pageSize));
+        pdf.setPageOrientation(layout.size.width() > layout.size.height() ? QPageLayout::Landscape : QPageLayout::Portrait);
+    }
+    pdf.setPageMargins(QMarginsF(0, 0, 0, 0));
+
+    QPainter painter;
+    if (!painter.begin(&pdf)) {
+        if (error) *error = QObject::tr("Не удалось открыть файл для записи");
+        return false;
+    }
+
+    // Схема вписывается в лист с сохранением пропорций и по центру
+    const qreal scale = qMin(pdf.width() / layout.size.width(), pdf.height() / layout.size.height());
+    painter.translate((pdf.width() - layout.size.width() * scale) / 2,
+                      (pdf.height() - layout.size.height() * scale) / 2);
+    painter.scale(scale, scale);
+    renderDocument(view, &painter, layout);
+    return painter.end();
+}
@@ -0,0 +1,58 @@
+#ifndef SCHEMATICEXPORTER_H
+#define SCHEMATICEXPORTER_H
+
+#include <QByteArray>
+#include <QPageSize>
+#include <QPainter>
+#include <QRectF>
+#include <QString>
+#include "signalvisualizerview.h"
+
+// Экспорт раскрашенной схемы вместе с легендой.
+// PNG собирается в одно изображение из плиток, которые рисуются параллельно с записанного
+// списка команд отрисовки; размер изображения ограничен maxRasterPixels.
+// SVG и PDF векторные, растровое изображение целиком не создаётся. QSvgGenerator держит
+// весь документ в памяти до завершения отрисовки, поэтому очень большие схемы экспортируются в PDF.
+class SchematicExporter {
+public:
+    struct Options {
+        int dpi = 300;
+        int tileSize = 2048;
+        bool includeLegend = true;
+        // Для PDF: формат листа, схема вписывается с сохранением пропорций. Custom - лист по размеру схемы
+        QPageSize::PageSizeId pageSize = QPageSize::Custom;
+        // Предел размера PNG: QImageWriter кодирует только изображение целиком, поэтому
+        // итоговый буфер (4 байта на пиксель) держится в памяти. 32 Мп - около 128 МБ;
+        // плакаты формата A0 при 300 dpi (~140 Мп) экспортируются в PDF
+        qint64 maxRasterPixels = 32LL * 1024 * 1024;
+        // Предел числа элементов сцены для SVG, большие схемы экспортируются в PDF
+        int maxSvgItems = 200000;
+    };
+
+    static bool exportToFile(SignalVisualizerView* view, const QString& fileName,
+                             const Options& options, QString* error = nullptr);
+
+private:
+    // Расположение схемы и легенды в единицах сцены
+    struct DocumentLayout {
+        QRectF source;
+        QRectF sceneTarget;
+        QPointF legendOrigin;
+        LegendWidget::Layout legend;
+        QSizeF size;
+    };
+
+    static DocumentLayout layoutDocument(SignalVisualizerView* view, const Options& options);
+    static void renderDocument(SignalVisualizerView* view, QPainter* painter, const DocumentLayout& layout);
+
+    static bool exportRaster(SignalVisualizerView* view, const QString& fileName,
+                             const Options& options, QString* error);
+    static bool exportSvg(SignalVisualizerView* view, const QString& fileName,
+                          const Options& options, QString* error);
+    static bool exportPdf(SignalVisualizerView* view, const QString& fileName,
+                          const Options& options, QString* error);
+
+    static QImage renderTile(const QByteArray& picture, const QRect& tile, qreal scale);
+};
+
+#endif // SCHEMATICEXPORTER_H
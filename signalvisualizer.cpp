@@ -1,39 +1,38 @@
 #include "signalvisualizer.h"
+#include "colorschemebinary.h"
+#include "classificationcache.h"
+#include "compresseddevice.h"
+#include "netbuilder.h"
+#include "stablehash.h"
 
 SignalVisualizer::SignalVisualizer(QObject *parent)
     : QObject(parent),
     m_systemTypes{"Power", "Control Signals", "Data Signals", "GPIO"},
     m_systemDesignationsTypes{"Power"},
     m_sourceHandlers{
-        {"Rail", [this](NetFlags& f, double& v, QString& d, Component* c, const QString&) {
-            if (auto r = dynamic_cast<Rail*>(c)) {
-                f.isSource = f.isRail = true;
-                v = r->volt();
-                d = formatVoltage(v) + "V";
-            }
+        {"Rail", [this](NetFlags& f, double& v, QString& d, const NetPinInfo& p) {
+            f.isSource = f.isRail = true;
+            v = p.value;
+            d = formatVoltage(v) + "V";
         }},
-        {"Fixed Voltage", [this](NetFlags& f, double& v, QString& d, Component* c, const QString&) {
-            if (auto fv = dynamic_cast<FixedVolt*>(c)) {
-                f.isSource = f.isRail = true;
-                v = fv->volt();
-                d = formatVoltage(v) + "V";
-            }
+        {"Fixed Voltage", [this](NetFlags& f, double& v, QString& d, const NetPinInfo& p) {
+            f.isSource = f.isRail = true;
+            v = p.value;
+            d = formatVoltage(v) + "V";
         }},
-        {"Battery", [this](NetFlags& f, double& v, QString& d, Component* c, const QString& pid) {
-            if (auto b = dynamic_cast<Battery*>(c)) {
-                v = b->volt();
-                bool isPlus = pid.contains("lPin", Qt::CaseInsensitive);
-                if (isPlus) {
-                    f.isBattPlus = f.isSource = true;
-                    d = formatVoltage(v) + "VBATT+";
-                } else {
-                    f.isBattMinus = f.isSource = true;
-                    d = formatVoltage(v) + "VBATT-";
-                }
-                if (!d.isEmpty()) d.remove(0, 1);
+        {"Battery", [this](NetFlags& f, double& v, QString& d, const NetPinInfo& p) {
+            v = p.value;
+            bool isPlus = p.pinId.contains("lPin", Qt::CaseInsensitive);
+            if (isPlus) {
+                f.isBattPlus = f.isSource = true;
+                d = formatVoltage(v) + "VBATT+";
+            } else {
+                f.isBattMinus = f.isSource = true;
+                d = formatVoltage(v) + "VBATT-";
             }
+            if (!d.isEmpty()) d.remove(0, 1);
         }},
-        {"Ground", [this](NetFlags& f, double& /*v*/, QString& /*d*/, Component* /*c*/, const QString& /*pid*/) {
+        {"Ground", [this](NetFlags& f, double& /*v*/, QString& /*d*/, const NetPinInfo& /*p*/) {
             f.isGround = f.isSource = true;
         }}
     },
@@ -82,7 +81,7 @@ SignalVisualizer::SignalVisualizer(QObject *parent)
         }}
     },
     m_multiHandlers {
-        {"MCU", [this](NetFlags& f, QString& d, Component* c, const QString& pid) {
+        {"MCU", [this](NetFlags& f, QString& d, const QString& pid) {
             QRegularExpression regex("^[\\w\\s]+-\\d+-PORT([A-Z][a-zA-Z0-9]+)$", QRegularExpression::CaseInsensitiveOption);
             QRegularExpressionMatch match = regex.match(pid);
 
@@ -100,15 +99,15 @@ SignalVisualizer::SignalVisualizer(QObject *parent)
             }
         }},
         
-        {"I2CToParallel", [this](NetFlags& f, QString& d, Component* c, const QString& pid) {
+        {"I2CToParallel", [this](NetFlags& f, QString& d, const QString& pid) {
             if (matchRegex(pid,"^I2C\\s*to\\s*Parallel-\\d+-in0$")) f.isSDA = f.isDestination = true;
             else if (matchRegex(pid,"^I2C\\s*to\\s*Parallel-\\d+-in1$")) f.isSCL = f.isDestination = true;
         }},
-        {"SerialPort", [this](NetFlags& f, QString& d, Component* c, const QString& pid) {
+        {"SerialPort", [this](NetFlags& f, QString& d, const QString& pid) {
             if (matchRegex(pid,"^SerialPort-\\d+-pin0$")) f.isTx = f.isSource = true;
             else if (matchRegex(pid,"^SerialPort-\\d+-pin1$")) f.isRx = f.isDestination = true;
         }},
-        {"Esp01", [this](NetFlags& f, QString& d, Component* c, const QString& pid) {
+        {"Esp01", [this](NetFlags& f, QString& d, const QString& pid) {
             if (matchRegex(pid,"^Esp01-\\d+-pin0$")) f.isTx = f.isSource = true;
             else if (matchRegex(pid,"^Esp01-\\d+-pin1$")) f.isRx = f.isDestination = true;
         }}
@@ -178,6 +177,13 @@ SignalVisualizer::SignalVisualizer(QObject *parent)
     // Конструктор
 }
 
+SignalVisualizer::~SignalVisualizer() {
+    cancelColorize();
+    cancelConfigLoad();
+    m_colorizeWatcher.waitForFinished();
+    m_configLoadWatcher.waitForFinished();
+}
+
 bool SignalVisualizer::isSystemType(const QString& type) const {
     return m_systemTypes.contains(type);
 }
@@ -187,42 +193,157 @@ bool SignalVisualizer::isSystemDesignationType(const QString& type) const {
 }
 
 void SignalVisualizer::colorizeCircuit() {
-    for (auto& net : m_netConnections) {
-        NetFlags flags;
-        QString designation;
-        analyzePins(net, flags, designation);
+    const QHash<QString, QList<NetPinInfo>> snapshot = snapshotNets();
+    commitClassification(classifyWithCache(snapshot, classificationCacheFile(), nullptr));
+}
 
-        SignalAttributes attr;
-        determineSignalType(flags, designation, attr);
+void SignalVisualizer::colorizeCircuitAsync() {
+    cancelColorize();
+    m_colorizeWatcher.waitForFinished();
+
+    // Снимок сетей делается в GUI-потоке, классификация работает только с копией данных
+    const QHash<QString, QList<NetPinInfo>> snapshot = snapshotNets();
+    auto cancelled = std::make_shared<std::atomic_bool>(false);
+    m_colorizeCancelled = cancelled;
+
+    disconnect(&m_colorizeWatcher, nullptr, this, nullptr);
+    connect(&m_colorizeWatcher, &QFutureWatcher<QHash<QString, SignalAttributes>>::finished, this, [this, cancelled]() {
+        if (cancelled->load()) return;
+        commitClassification(m_colorizeWatcher.result());
+    });
+
+    const QString cacheFile = classificationCacheFile();
+    m_colorizeWatcher.setFuture(QtConcurrent::run([this, snapshot, cacheFile, cancelled]() {
+        return classifyWithCache(snapshot, cacheFile, cancelled.get());
+    }));
+}
 
-        applyLineAppearance(attr, net);
+void SignalVisualizer::cancelColorize() {
+    if (m_colorizeCancelled) {
+        m_colorizeCancelled->store(true);
     }
-    assignVoltageGradientColors();
-    emit comboUpdated();
-    emit colorizeFinished();
 }
 
-void SignalVisualizer::analyzePins(const NetConnections& net, NetFlags& flags, QString& designation) {
+bool SignalVisualizer::isColorizing() const {
+    return m_colorizeWatcher.isRunning();
+}
+
+QList<SignalVisualizer::NetPinInfo> SignalVisualizer::collectPinInfo(const NetConnections& net) const {
+    QList<NetPinInfo> result;
+    result.reserve(net.pinList.size());
+
     for (Pin* pin : net.pinList) {
         if (!pin) continue;
 
         Component* comp = dynamic_cast<Component*>(pin->parentItem());
         if (!comp) continue;
 
-        const QString compType = comp->itemType();
-        const QString pinId = pin->pinId();
+        NetPinInfo info;
+        info.pinId = pin->pinId();
+        info.compType = comp->itemType();
+
+        if (auto r = dynamic_cast<Rail*>(comp)) info.value = r->volt();
+        else if (auto fv = dynamic_cast<FixedVolt*>(comp)) info.value = fv->volt();
+        else if (auto b = dynamic_cast<Battery*>(comp)) info.value = b->volt();
+
+        result.append(info);
+    }
+    return result;
+}
+
+QHash<QString, QList<SignalVisualizer::NetPinInfo>> SignalVisualizer::snapshotNets() const {
+    QHash<QString, QList<NetPinInfo>> snapshot;
+    snapshot.reserve(m_netConnections.size());
+
+    for (auto it = m_netConnections.cbegin(); it != m_netConnections.cend(); ++it) {
+        snapshot.insert(it.key(), collectPinInfo(it.value()));
+    }
+    return snapshot;
+}
+
+QString SignalVisualizer::classificationCacheFile() const {
+    Circuit* circuit = Circuit::self();
+    return circuit ? ClassificationCache::cacheFileName(circuit->getFilePath()) : QString();
+}
+
+QHash<QString, SignalVisualizer::SignalAttributes> SignalVisualizer::classifyWithCache(
+        const QHash<QString, QList<NetPinInfo>>& snapshot, const QString& cacheFile, const std::atomic_bool* cancelled) {
+    QHash<QString, quint64> fingerprints;
+    fingerprints.reserve(snapshot.size());
+    for (auto it = snapshot.cbegin(); it != snapshot.cend(); ++it) {
+        fingerprints.insert(it.key(), ClassificationCache::netFingerprint(it.value()));
+    }
+    const quint64 circuitFingerprint = ClassificationCache::circuitFingerprint(fingerprints);
+
+    ClassificationCache cache;
+    const bool cached = !cacheFile.isEmpty() && cache.load(cacheFile);
+    const bool unchanged = cached && cache.circuitFingerprint() == circuitFingerprint;
+
+    // Для неизменённой схемы все цепи берутся из кэша, иначе классифицируются только новые
+    QHash<QString, SignalAttributes> result;
+    ClassificationCache updated;
+    updated.setCircuitFingerprint(circuitFingerprint);
+
+    for (auto it = snapshot.cbegin(); it != snapshot.cend(); ++it) {
+        if (cancelled && cancelled->load()) return result;
+
+        const quint64 fingerprint = fingerprints.value(it.key());
+        SignalAttributes attr;
+        if (!cache.lookup(fingerprint, attr)) {
+            attr = classifyNet(it.value());
+        }
+        result.insert(it.key(), attr);
+        updated.insert(fingerprint, attr);
+    }
+
+    // Записи исчезнувших цепей в файл не попадают
+    if (!cacheFile.isEmpty() && !unchanged) {
+        updated.save(cacheFile);
+    }
+    return result;
+}
+
+SignalVisualizer::SignalAttributes SignalVisualizer::classifyNet(const QList<NetPinInfo>& pins) {
+    NetFlags flags;
+    QString designation;
+    analyzePins(pins, flags, designation);
+
+    SignalAttributes attr;
+    determineSignalType(flags, designation, attr);
+    return attr;
+}
+
+void SignalVisualizer::commitClassification(const QHash<QString, SignalAttributes>& attributes) {
+    for (auto it = attributes.cbegin(); it != attributes.cend(); ++it) {
+        auto net = m_netConnections.find(it.key());
+        if (net == m_netConnections.end()) continue;
+        applyLineAppearance(it.value(), net.value());
+    }
+    assignVoltageGradientColors();
+    assignPaletteSlots();
+    buildComponentIndex();
+    rebuildSearchIndex();
+    markChanged(GeometryChanged);
+    emit colorizeFinished();
+}
+
+void SignalVisualizer::analyzePins(const QList<NetPinInfo>& pins, NetFlags& flags, QString& designation) {
+    for (const NetPinInfo& pin : pins) {
         double value = 0.0;
 
-        if (m_sourceHandlers.contains(compType)) {
-            m_sourceHandlers[compType](flags, value, designation, comp, pinId);
+        auto source = m_sourceHandlers.constFind(pin.compType);
+        if (source != m_sourceHandlers.cend()) {
+            source.value()(flags, value, designation, pin);
         }
 
-        if (m_destHandlers.contains(compType)) {
-            m_destHandlers[compType](flags, pinId);
+        auto dest = m_destHandlers.constFind(pin.compType);
+        if (dest != m_destHandlers.cend()) {
+            dest.value()(flags, pin.pinId);
         }
 
-        if (m_multiHandlers.contains(compType)) {
-            m_multiHandlers[compType](flags, designation, comp, pinId);
+        auto multi = m_multiHandlers.constFind(pin.compType);
+        if (multi != m_multiHandlers.cend()) {
+            multi.value()(flags, designation, pin.pinId);
         }
     }
 }
@@ -316,113 +437,30 @@ void SignalVisualizer::applyLineAppearance(const SignalAttributes& attr, NetConn
 void SignalVisualizer::updateConnectionsMap(Pin* startPin, Pin* endpin, QList<QGraphicsLineItem*>& lineItems) {
     QString startId = startPin->pinId();
     QString endId = endpin->pinId();
-    bool startIsNode = startId.contains("Node", Qt::CaseInsensitive);
-    bool endIsNode = endId.contains("Node", Qt::CaseInsensitive);
-    QString mapKeyStart = startIsNode ? findMatchingKeyForNodeConnection(startId, m_netConnections): findMatchingKeyForPin(startId, m_netConnections);
-    QString mapKeyEnd   = endIsNode ? findMatchingKeyForNodeConnection(endId, m_netConnections) : findMatchingKeyForPin(endId, m_netConnections);
-    QString targetKey;
-
-    if (!mapKeyStart.isEmpty()) targetKey = mapKeyStart;
-    else if (!mapKeyEnd.isEmpty()) targetKey = mapKeyEnd;
-
-    if (!targetKey.isEmpty()) {
-        m_netConnections[targetKey].lineList.append(lineItems);
-        m_netConnections[targetKey].pinList.append(startPin);
-        m_netConnections[targetKey].pinList.append( endpin);
-        if (!mapKeyStart.isEmpty() && !mapKeyEnd.isEmpty() && mapKeyStart != mapKeyEnd) {
-            mergeDuplicateKeysNodes(m_netConnections);
-        }
-    } else {
-        QList<Pin*> pins = { startPin,  endpin };
-        QString newKey = (!startIsNode && endIsNode) ? startId : (startIsNode && !endIsNode) ? endId : startId;
-        m_netConnections[newKey] = NetConnections(lineItems, pins);
-    }
-}
-
-void SignalVisualizer::mergeDuplicateKeysNodes(QMap<QString, NetConnections>& m_netConnections) {
-    QList<QString> keysToRemove;
-    QList<QString> allKeys = m_netConnections.keys();
-    QHash<QString, QSet<QString>> nodeGroups;
-
-    for (const QString& key : allKeys) {
-        if (!m_netConnections.contains(key)) continue;
-        
-        NetConnections& net = m_netConnections[key];
-        for (Pin* pin : net.pinList) {
-            QString pinId = pin->pinId();
-            QRegularExpressionMatch match = QRegularExpression("^Node-(\\d+)-", QRegularExpression::CaseInsensitiveOption).match(pinId);
-            if (match.hasMatch()) {
-                QString nodeNum = match.captured(1);
-                nodeGroups[nodeNum].insert(key);
-            }
-        }
-    }
-
-    for (const auto& group : nodeGroups) {
-        if (group.size() < 2) continue;
-
-        QString mainKey = *group.begin();
-        if (!m_netConnections.contains(mainKey)) continue;
-
-        NetConnections& mainNet = m_netConnections[mainKey];
-        QSet<QGraphicsLineItem*> uniqueLines(mainNet.lineList.begin(), mainNet.lineList.end());
-        QSet<Pin*> uniquePins(mainNet.pinList.begin(), mainNet.pinList.end());
-
-        for (const QString& key : group) {
-            if (key == mainKey || !m_netConnections.contains(key)) continue;
-            
-            NetConnections& net = m_netConnections[key];
-            uniqueLines.unite(QSet<QGraphicsLineItem*>(net.lineList.begin(), net.lineList.end()));
-            uniquePins.unite(QSet<Pin*>(net.pinList.begin(), net.pinList.end()));
-            keysToRemove.append(key);
-        }
-
-        mainNet.lineList = QList<QGraphicsLineItem*>(uniqueLines.begin(), uniqueLines.end());
-        mainNet.pinList = QList<Pin*>(uniquePins.begin(), uniquePins.end());
-    }
-    // Удаляем дубликаты
-    for (const QString& key : keysToRemove) {
-        m_netConnections.remove(key);
-    }
+    m_netBuilder.addConnection(startId, endId);
+    m_builderPins.insert(startId, startPin);
+    m_builderPins.insert(endId, endpin);
+    m_builderLines[startId].append(lineItems);
 }
 
-QString SignalVisualizer::findMatchingKeyForNodeConnection(const QString& pinId, QMap<QString, NetConnections>& m_netConnections) {
-    QRegularExpression regex("^Node-(\\d+)-\\d+$", QRegularExpression::CaseInsensitiveOption);
-    QRegularExpressionMatch match = regex.match(pinId);
-
-    if (!match.hasMatch()) return QString();
-
-    QString nodeGroup = match.captured(1);
-
-    for (auto it = m_netConnections.begin(); it != m_netConnections.end(); ++it) {
-        const QList<Pin*>& pinList = it.value().pinList;
-
-        for (Pin* pin : pinList) {
-            if (!pin) continue;
-
-            QString otherPinId = pin->pinId();
-            QRegularExpressionMatch otherMatch = regex.match(otherPinId);
-            if (otherMatch.hasMatch() && otherMatch.captured(1) == nodeGroup) {
-                return it.key();
-            }
+void SignalVisualizer::finishConnectionsMap() {
+    // Ключи цепей окончательны только после всех соединений: слияние по узлам их меняет
+    const QMap<QString, QStringList>& nets = m_netBuilder.nets();
+    for (auto it = nets.cbegin(); it != nets.cend(); ++it) {
+        QList<QGraphicsLineItem*> lines;
+        QList<Pin*> pins;
+        for (const QString& pinId : it.value()) {
+            if (Pin* pin = m_builderPins.value(pinId)) pins.append(pin);
+            lines.append(m_builderLines.take(pinId));
         }
+        NetConnections& net = m_netConnections[it.key()];
+        net = NetConnections(lines, pins);
+        net.key = it.key();
     }
 
-    return QString();
-}
-
-QString SignalVisualizer::findMatchingKeyForPin(const QString& pinId, QMap<QString, NetConnections>& m_netConnections){
-    for (auto it = m_netConnections.begin(); it != m_netConnections.end(); ++it) {
-        QList<Pin*> pinList = it.value().pinList;
-
-        for (Pin* pin : pinList) {
-            QString currentPinId = pin->pinId();
-            if (pinId == currentPinId) {
-                return it.key();
-            }
-        }
-    }
-    return QString();
+    m_netBuilder = NetBuilder();
+    m_builderPins.clear();
+    m_builderLines.clear();
 }
 
 void SignalVisualizer::assignVoltageGradientColors() {
@@ -468,16 +506,20 @@ void SignalVisualizer::assignVoltageGradientColors() {
         double voltage = it.value();
 
         double t = (maxV == minV) ? 1.0 : (voltage - minV) / (maxV - minV);
-        int red = static_cast<int>(155 + t * (255 - 155));
-        QColor color(red, 0, 0);
+        QColor color = voltageGradientColor(t);
 
         for (const QString& key : typeToKeys[type]) {
             m_netConnections[key].designationColor = color;
-            applyColorToLineGroup(color, m_netConnections[key].lineList);
         }
     }
 }
 
+QColor SignalVisualizer::voltageGradientColor(double t) {
+    t = qBound(0.0, t, 1.0);
+    int red = static_cast<int>(155 + t * (255 - 155));
+    return QColor(red, 0, 0);
+}
+
 QString SignalVisualizer::formatVoltage(double value) {
     if (std::floor(value) == value) {
         return QString::asprintf("%+.0f", value);
@@ -495,54 +537,219 @@ bool SignalVisualizer::matchRegex(const QString& pinId, const QString& pattern)
         .match(pinId).hasMatch();
 }
 
+void SignalVisualizer::touchNet(NetConnections& net, ChangeAspects aspects) {
+    // Исходное состояние сети запоминается один раз за правку, до первого изменения
+    if (m_styleEditDepth > 0 && !m_styleEditBefore.contains(net.key)) {
+        m_styleEditBefore.insert(net.key, netStyle(net));
+    }
+    net.dirty = true;
+    markChanged(aspects, net.key);
+}
+
+void SignalVisualizer::markChanged(ChangeAspects aspects, const QString& key) {
+    m_pendingAspects |= aspects;
+    if (!key.isEmpty()) m_pendingNets.insert(key);
+
+    if (m_changesScheduled) return;
+    m_changesScheduled = true;
+    QMetaObject::invokeMethod(this, &SignalVisualizer::flushChanges, Qt::QueuedConnection);
+}
+
+void SignalVisualizer::flushChanges() {
+    m_changesScheduled = false;
+
+    QSet<QString> nets;
+    nets.swap(m_pendingNets);
+
+    const ChangeAspects aspects = m_pendingAspects;
+    m_pendingAspects = ChangeAspects();
+
+    // После перестройки индекс уже полный, иначе переиндексируются только изменённые сети
+    if (!(aspects & GeometryChanged)) {
+        for (const QString& key : nets) {
+            auto net = m_netConnections.constFind(key);
+            if (net == m_netConnections.cend()) m_searchIndex.removeNet(key);
+            else indexNet(key, net.value());
+        }
+    }
+
+    if (aspects) emit modelChanged(aspects, nets);
+}
+
+void SignalVisualizer::beginStyleEdit() {
+    ++m_styleEditDepth;
+}
+
+QList<SignalVisualizer::NetStyleChange> SignalVisualizer::endStyleEdit() {
+    QList<NetStyleChange> changes;
+    if (m_styleEditDepth == 0 || --m_styleEditDepth > 0) return changes;
+    if (m_styleEditBefore.isEmpty()) return changes;
+
+    for (auto before = m_styleEditBefore.cbegin(); before != m_styleEditBefore.cend(); ++before) {
+        auto net = m_netConnections.constFind(before.key());
+        if (net == m_netConnections.cend()) continue;
+
+        ConfigNet after = netStyle(net.value());
+        if (!sameStyle(before.value(), after)) {
+            changes.append({before.key(), before.value(), after});
+        }
+    }
+    m_styleEditBefore.clear();
+    return changes;
+}
+
+void SignalVisualizer::applyNetStyles(const QList<ConfigUpdate>& styles) {
+    for (const ConfigUpdate& style : styles) {
+        auto it = m_netConnections.find(style.key);
+        if (it != m_netConnections.end()) {
+            it.value().dirty = true;
+        }
+    }
+    commitConfigUpdates(styles);
+}
+
+SignalVisualizer::ConfigNet SignalVisualizer::netStyle(const NetConnections& connection) const {
+    // Только оформление сети, без набора пинов
+    ConfigNet style;
+    style.attributes.designation = connection.designation;
+    style.attributes.designationColor = connection.designationColor;
+    style.attributes.designationInfo = connection.designationInfo;
+    style.attributes.type = connection.type;
+    style.attributes.typeColor = connection.typeColor;
+    style.attributes.typeInfo = connection.typeInfo;
+    style.lineWidth = connection.lineList.isEmpty() ? 1 : lineWidth(connection.lineList.first());
+    return style;
+}
+
+bool SignalVisualizer::sameStyle(const ConfigNet& a, const ConfigNet& b) {
+    return a.attributes.designation == b.attributes.designation
+        && a.attributes.designationColor == b.attributes.designationColor
+        && a.attributes.designationInfo == b.attributes.designationInfo
+        && a.attributes.type == b.attributes.type
+        && a.attributes.typeColor == b.attributes.typeColor
+        && a.attributes.typeInfo == b.attributes.typeInfo
+        && a.lineWidth == b.lineWidth;
+}
+
 void SignalVisualizer::setDesignation(const QString& designation, NetConnections& net) {
     net.designation = designation;
+    touchNet(net, CatalogChanged | StylesChanged);
 }
 
 void SignalVisualizer::setType(const QString& type, NetConnections& net) {
     net.type = type;
+    touchNet(net, CatalogChanged | StylesChanged);
 }
 
 void SignalVisualizer::setDesignationLineColor(const QColor& color, NetConnections& net) {
     net.designationColor = color;
+    m_palette.setDesignationColor(net.paletteSlot, color);
+    touchNet(net, CatalogChanged | StylesChanged);
 }
 
 void SignalVisualizer::setTypeLineColor(const QColor& color, NetConnections& net) {
     net.typeColor = color;
+    m_palette.setTypeColor(net.paletteSlot, color);
+    touchNet(net, CatalogChanged | StylesChanged);
 }
 
 void SignalVisualizer::setDesignationInfo(const QString& info, NetConnections& net) {
     net.designationInfo = info;
+    touchNet(net);
 }
 
 void SignalVisualizer::setTypeInfo(const QString& info, NetConnections& net) {
     net.typeInfo = info;
+    touchNet(net);
 }
 
 void SignalVisualizer::applyColorToLineGroup(QColor color, QList<QGraphicsLineItem*>& lineGroup) {
     for (QGraphicsLineItem* line : lineGroup) {
-        QPen currentPen = line->pen();
-        currentPen.setColor(color);
-        line->setPen(currentPen);
+        if (WireItem* wire = dynamic_cast<WireItem*>(line)) {
+            wire->setOverrideColor(color);
+        }
+    }
+}
+
+void SignalVisualizer::clearColorOverride(const QList<QGraphicsLineItem*>& lineGroup) {
+    for (QGraphicsLineItem* line : lineGroup) {
+        if (WireItem* wire = dynamic_cast<WireItem*>(line)) {
+            wire->clearOverrideColor();
+        }
     }
 }
 
 void SignalVisualizer::applyThicknessToLineGroup(int thickness, const QList<QGraphicsLineItem*>& lineGroup) {
     for (QGraphicsLineItem* line : lineGroup) {
-        if (line) {
-            QPen pen = line->pen();
-            pen.setWidth(thickness);
-            line->setPen(pen);
+        if (!line) continue;
+
+        if (m_styleCommitDepth > 0) {
+            m_pendingWidths.insert(line, thickness);
+        } else {
+            setLineWidth(line, thickness);
         }
     }
 }
 
+void SignalVisualizer::beginStyleCommit() {
+    ++m_styleCommitDepth;
+}
+
+void SignalVisualizer::endStyleCommit() {
+    if (m_styleCommitDepth == 0 || --m_styleCommitDepth > 0) return;
+    if (m_pendingWidths.isEmpty()) return;
+
+    // Каждая смена ширины меняет границы отрезка и обновляет его в BSP-дереве.
+    // Для крупного пакета дешевле отключить индекс и построить его заново один раз.
+    const int IndexRebuildThreshold = 64;
+    QGraphicsScene* scene = m_pendingWidths.cbegin().key()->scene();
+    const bool suspendIndex = scene && m_pendingWidths.size() >= IndexRebuildThreshold
+                              && scene->itemIndexMethod() == QGraphicsScene::BspTreeIndex;
+
+    if (suspendIndex) scene->setItemIndexMethod(QGraphicsScene::NoIndex);
+    for (auto it = m_pendingWidths.cbegin(); it != m_pendingWidths.cend(); ++it) {
+        setLineWidth(it.key(), it.value());
+    }
+    if (suspendIndex) scene->setItemIndexMethod(QGraphicsScene::BspTreeIndex);
+
+    m_pendingWidths.clear();
+}
+
+int SignalVisualizer::lineWidth(const QGraphicsLineItem* line) const {
+    auto pending = m_pendingWidths.constFind(const_cast<QGraphicsLineItem*>(line));
+    if (pending != m_pendingWidths.cend()) return pending.value();
+    return qRound(line->pen().widthF());
+}
+
+void SignalVisualizer::setLineWidth(QGraphicsLineItem* line, int width) {
+    // Перо с той же шириной не трогаем: setPen сбрасывает границы отрезка
+    if (line->pen().width() == width) return;
+
+    QPen pen = line->pen();
+    pen.setWidth(width);
+    line->setPen(pen);
+}
+
 void SignalVisualizer::updateNetColors(bool showCategories) {
+    // Снимает всю временную подсветку, провода снова берут цвет из палитры
+    m_palette.setShowTypes(showCategories);
     for (auto& connection : m_netConnections) {
-        if (showCategories){
-            applyColorToLineGroup(connection.typeColor, connection.lineList);
-        } else {
-            applyColorToLineGroup(connection.designationColor, connection.lineList);
+        clearColorOverride(connection.lineList);
+    }
+}
+
+void SignalVisualizer::assignPaletteSlots() {
+    m_palette.clear();
+    m_slotKeys.clear();
+    m_slotKeys.reserve(m_netConnections.size());
+    for (auto it = m_netConnections.begin(); it != m_netConnections.end(); ++it) {
+        NetConnections& connection = it.value();
+        connection.paletteSlot = m_palette.addSlot(connection.designationColor, connection.typeColor);
+        m_slotKeys.append(it.key());
+        for (QGraphicsLineItem* line : connection.lineList) {
+            if (WireItem* wire = dynamic_cast<WireItem*>(line)) {
+                wire->setPaletteSlot(connection.paletteSlot);
+            }
         }
     }
 }
@@ -553,7 +760,7 @@ void SignalVisualizer::setDesignationByGroup(const QString& designation, QList<Q
     for (auto& connection : m_netConnections) {
         QSet<QGraphicsLineItem*> connectionSet = QSet<QGraphicsLineItem*>(connection.lineList.begin(), connection.lineList.end());
         if (inputSet == connectionSet) {
-            connection.designation = designation;
+            setDesignation(designation, connection);
         }
     }
 }
@@ -573,7 +780,7 @@ void SignalVisualizer::setDesignationInfoByGroup(const QString& info, QList<QGra
 
     for (auto& connection : m_netConnections) {
         if (connection.designation == targetDesignation && connection.type == targetType) {
-            connection.designationInfo = info;
+            setDesignationInfo(info, connection);
         }
     }
 }
@@ -584,7 +791,7 @@ void SignalVisualizer::setTypeByGroup(const QString& type, QList<QGraphicsLineIt
     for (auto& connection : m_netConnections) {
         QSet<QGraphicsLineItem*> connectionSet = QSet<QGraphicsLineItem*>(connection.lineList.begin(), connection.lineList.end());
         if (inputSet == connectionSet) {
-            connection.type = type;
+            setType(type, connection);
         }
     }
 }
@@ -603,7 +810,7 @@ void SignalVisualizer::setTypeInfoByGroup(const QString& info, QList<QGraphicsLi
 
     for (auto& connection : m_netConnections) {
         if (connection.type == targetType) {
-            connection.typeInfo = info;
+            setTypeInfo(info, connection);
         }
     }
 }
@@ -623,7 +830,7 @@ void SignalVisualizer::setDesignationLineColorByGroup(QColor color, QList<QGraph
 
     for (auto& connection : m_netConnections) {
         if (connection.designation == targetDesignation && connection.type == targetType) {
-            connection.designationColor = color;
+            setDesignationLineColor(color, connection);
         }
     }
 }
@@ -642,7 +849,7 @@ void SignalVisualizer::setTypeLineColorByGroup(QColor color, QList<QGraphicsLine
 
     for (auto& connection : m_netConnections) {
         if (connection.type == targetType) {
-            connection.typeColor = color;
+            setTypeLineColor(color, connection);
         }
     }
 }
@@ -794,6 +1001,93 @@ QList<QGraphicsLineItem*> SignalVisualizer::getGroupByLine(QGraphicsLineItem* li
     return result;
 }
 
+QString SignalVisualizer::netKeyByLine(const QGraphicsLineItem* lineItem) const {
+    // Провод знает ячейку палитры своей сети, а ячейка - ключ сети
+    const WireItem* wire = dynamic_cast<const WireItem*>(lineItem);
+    if (wire && wire->paletteSlot() >= 0 && wire->paletteSlot() < m_slotKeys.size()) {
+        return m_slotKeys[wire->paletteSlot()];
+    }
+
+    for (auto it = m_netConnections.cbegin(); it != m_netConnections.cend(); ++it) {
+        if (it.value().lineList.contains(const_cast<QGraphicsLineItem*>(lineItem))) return it.key();
+    }
+    return QString();
+}
+
+void SignalVisualizer::buildComponentIndex() {
+    m_componentNets.clear();
+    m_netComponents.clear();
+    m_netComponents.resize(m_slotKeys.size());
+
+    for (auto it = m_netConnections.cbegin(); it != m_netConnections.cend(); ++it) {
+        const int slot = it.value().paletteSlot;
+        if (slot < 0 || slot >= m_netComponents.size()) continue;
+
+        QVector<Component*>& components = m_netComponents[slot];
+        for (Pin* pin : it.value().pinList) {
+            if (!pin) continue;
+
+            Component* comp = dynamic_cast<Component*>(pin->parentItem());
+            // У компонента несколько пинов в одной цепи, ребро храним один раз
+            if (!comp || components.contains(comp)) continue;
+
+            components.append(comp);
+            m_componentNets[comp].append(slot);
+        }
+    }
+}
+
+QStringList SignalVisualizer::netsOfComponent(Component* component) const {
+    QStringList keys;
+    auto nets = m_componentNets.constFind(component);
+    if (nets == m_componentNets.cend()) return keys;
+
+    keys.reserve(nets->size());
+    for (int slot : *nets) {
+        keys.append(m_slotKeys[slot]);
+    }
+    return keys;
+}
+
+QList<Component*> SignalVisualizer::componentsOfNet(const QString& key) const {
+    auto net = m_netConnections.constFind(key);
+    if (net == m_netConnections.cend()) return QList<Component*>();
+
+    const int slot = net->paletteSlot;
+    if (slot < 0 || slot >= m_netComponents.size()) return QList<Component*>();
+    return QList<Component*>(m_netComponents[slot].cbegin(), m_netComponents[slot].cend());
+}
+
+QString SignalVisualizer::componentName(Component* component) {
+    Label* idLabel = component->getIdLabel();
+    QString name = idLabel ? idLabel->toPlainText() : QString();
+    return name.isEmpty() ? component->itemType() : name;
+}
+
+void SignalVisualizer::rebuildSearchIndex() {
+    m_searchIndex.clear();
+    for (auto it = m_netConnections.cbegin(); it != m_netConnections.cend(); ++it) {
+        indexNet(it.key(), it.value());
+    }
+}
+
+void SignalVisualizer::indexNet(const QString& key, const NetConnections& net) {
+    QStringList terms = { net.designation, net.type };
+    for (Pin* pin : net.pinList) {
+        if (pin) terms.append(pin->pinId());
+    }
+    for (Component* comp : componentsOfNet(key)) {
+        terms.append(componentName(comp));
+    }
+
+    // Рамка нужна для перехода к найденной цепи, провода после построения не двигаются
+    QRectF bounds;
+    for (QGraphicsLineItem* line : net.lineList) {
+        bounds |= line->sceneBoundingRect();
+    }
+    m_searchIndex.updateNet(key, terms, bounds);
+}
+
 QString SignalVisualizer::getDesignationInfoByGroup(const QList<QGraphicsLineItem*>& lineGroup) const {
     QSet<QGraphicsLineItem*> in(lineGroup.begin(), lineGroup.end());
     for (auto &net : m_netConnections) {
@@ -827,6 +1121,7 @@ QString SignalVisualizer::getPositionalDesignation(const QString &type) {
 }
 
 void SignalVisualizer::removeDesignationForConnections(QString designation) {
+    beginStyleCommit();
     for (auto& connection : m_netConnections) {
         if (connection.designation == designation) {
             setDesignation("", connection);
@@ -834,27 +1129,13 @@ void SignalVisualizer::removeDesignationForConnections(QString designation) {
             setType("", connection);
             setTypeLineColor(Qt::darkGreen, connection);
             applyThicknessToLineGroup(3, connection.lineList);
-
-            SignalVisualizerWidget* widget = qobject_cast<SignalVisualizerWidget*>(parent());
-            QSet<QGraphicsLineItem*> selectedLinesSet;
-            if (widget) {
-                selectedLinesSet = QSet<QGraphicsLineItem*>(
-                    widget->getView()->getSelectedLineGroup().cbegin(),
-                    widget->getView()->getSelectedLineGroup().cend()
-                );
-            }
-            QSet<QGraphicsLineItem*> connectionLinesSet = QSet<QGraphicsLineItem*>(
-                connection.lineList.cbegin(),
-                connection.lineList.cend()
-            );
-            if (selectedLinesSet != connectionLinesSet) {
-                applyColorToLineGroup(Qt::darkGreen, connection.lineList); 
-            }
         }
     }
+    endStyleCommit();
 }
 
 void SignalVisualizer::removeTypeForConnections(const QString& type) {
+    beginStyleCommit();
     for (auto& connection : m_netConnections) {
         if (connection.type == type) {
             setDesignation("", connection);
@@ -862,24 +1143,56 @@ void SignalVisualizer::removeTypeForConnections(const QString& type) {
             setDesignationLineColor(Qt::darkGreen, connection);
             setTypeLineColor(Qt::darkGreen, connection);
             applyThicknessToLineGroup(3, connection.lineList);
+        }
+    }
+    endStyleCommit();
+}
 
-            SignalVisualizerWidget* widget = qobject_cast<SignalVisualizerWidget*>(parent());
-            QSet<QGraphicsLineItem*> selectedLinesSet;
-            if (widget) {
-                selectedLinesSet = QSet<QGraphicsLineItem*>(
-                    widget->getView()->getSelectedLineGroup().cbegin(),
-                    widget->getView()->getSelectedLineGroup().cend()
-                );
+void SignalVisualizer::applyStyleToNets(const QStringList& keys, const SignalAttributes& attr, int lineWidth) {
+    beginStyleCommit();
+    for (const QString& key : keys) {
+        auto it = m_netConnections.find(key);
+        if (it == m_netConnections.end()) continue;
+
+        setDesignation(attr.designation, it.value());
+        setType(attr.type, it.value());
+        touchNet(it.value());
+        applyThicknessToLineGroup(lineWidth, it.value().lineList);
+    }
+
+    // Как и при правке одной сети, цвет и описание обозначения общие для сетей с тем же
+    // обозначением и типом, а цвет и описание типа - для всех сетей этого типа
+    if (!keys.isEmpty()) {
+        for (auto& connection : m_netConnections) {
+            if (connection.designation == attr.designation && connection.type == attr.type) {
+                setDesignationLineColor(attr.designationColor, connection);
+                setDesignationInfo(attr.designationInfo, connection);
             }
-            QSet<QGraphicsLineItem*> connectionLinesSet = QSet<QGraphicsLineItem*>(
-                connection.lineList.cbegin(),
-                connection.lineList.cend()
-            );
-            if (selectedLinesSet != connectionLinesSet) {
-                applyColorToLineGroup(Qt::darkGreen, connection.lineList);
+            if (connection.type == attr.type) {
+                setTypeLineColor(attr.typeColor, connection);
+                setTypeInfo(attr.typeInfo, connection);
             }
         }
     }
+    endStyleCommit();
+}
+
+void SignalVisualizer::resetNets(const QStringList& keys) {
+    beginStyleCommit();
+    for (const QString& key : keys) {
+        auto it = m_netConnections.find(key);
+        if (it == m_netConnections.end()) continue;
+
+        NetConnections& connection = it.value();
+        setDesignation("", connection);
+        setDesignationInfo("", connection);
+        setType("", connection);
+        setTypeInfo("", connection);
+        setDesignationLineColor(Qt::darkGreen, connection);
+        setTypeLineColor(Qt::darkGreen, connection);
+        applyThicknessToLineGroup(3, connection.lineList);
+    }
+    endStyleCommit();
 }
 
 void SignalVisualizer::resetConnectionsByGroup(const QList<QGraphicsLineItem*>& lineGroup) {
@@ -899,115 +1212,405 @@ void SignalVisualizer::resetConnectionsByGroup(const QList<QGraphicsLineItem*>&
     }
 }
 
-QString SignalVisualizer::toString() {
-    QString result = "<colorSchemeConfig>";
+bool SignalVisualizer::writeConfig(QIODevice* device, bool infoTable) const {
+    // Запись идёт сразу в устройство; в памяти одновременно только одна сеть
+    QXmlStreamWriter xml(device);
+    xml.setAutoFormatting(true);
+    xml.setAutoFormattingIndent(2);
+    xml.writeStartDocument();
+    xml.writeStartElement("colorSchemeConfig");
+
+    QHash<QString, int> infoIds;
+    if (infoTable) {
+        xml.writeStartElement("infoTable");
+        for (const NetConnections& connection : m_netConnections) {
+            writeInfoEntry(xml, connection.designationInfo, infoIds);
+            writeInfoEntry(xml, connection.typeInfo, infoIds);
+        }
+        xml.writeEndElement();
+    }
 
-    for (auto it = m_netConnections.begin(); it != m_netConnections.end(); ++it) {
-        QString netName = it.key();
-        const NetConnections& connection = it.value();
+    for (auto it = m_netConnections.cbegin(); it != m_netConnections.cend(); ++it) {
+        writeConfigNet(xml, makeConfigNet(it.key(), it.value()), infoTable ? &infoIds : nullptr);
+    }
+
+    xml.writeEndElement();
+    xml.writeEndDocument();
+    return !xml.hasError();
+}
+
+void SignalVisualizer::writeConfigXml(QIODevice* device, const QList<ConfigNet>& nets, bool infoTable) {
+    QXmlStreamWriter xml(device);
+    xml.setAutoFormatting(true);
+    xml.setAutoFormattingIndent(2);
+    xml.writeStartDocument();
+    xml.writeStartElement("colorSchemeConfig");
+
+    // Длинные описания повторяются у многих цепей, в таблицу каждое попадает один раз
+    QHash<QString, int> infoIds;
+    if (infoTable) {
+        xml.writeStartElement("infoTable");
+        for (const ConfigNet& configNet : nets) {
+            writeInfoEntry(xml, configNet.attributes.designationInfo, infoIds);
+            writeInfoEntry(xml, configNet.attributes.typeInfo, infoIds);
+        }
+        xml.writeEndElement();
+    }
+
+    for (const ConfigNet& configNet : nets) {
+        writeConfigNet(xml, configNet, infoTable ? &infoIds : nullptr);
+    }
+
+    xml.writeEndElement();
+    xml.writeEndDocument();
+}
+
+void SignalVisualizer::writeConfigNet(QXmlStreamWriter& xml, const ConfigNet& configNet, const QHash<QString, int>* infoIds) {
+    writeNetStart(xml, configNet.name, configNet.attributes, QString::number(configNet.lineWidth), infoIds);
+
+    for (const QString& pinId : configNet.pinIds) {
+        xml.writeEmptyElement("pin");
+        xml.writeAttribute("id", pinId);
+    }
+
+    xml.writeEndElement();
+}
+
+void SignalVisualizer::writeInfoEntry(QXmlStreamWriter& xml, const QString& info, QHash<QString, int>& infoIds) {
+    if (info.isEmpty() || infoIds.contains(info)) return;
+
+    int id = infoIds.size();
+    infoIds.insert(info, id);
+    xml.writeEmptyElement("info");
+    xml.writeAttribute("id", QString::number(id));
+    xml.writeAttribute("text", info);
+}
+
+void SignalVisualizer::writeNetStart(QXmlStreamWriter& xml, const QString& name, const SignalAttributes& attr, const QString& lineWidth,
+                                     const QHash<QString, int>* infoIds) {
+    auto writeInfo = [&xml, infoIds](const QString& attribute, const QString& info) {
+        auto id = infoIds ? infoIds->constFind(info) : QHash<QString, int>::const_iterator();
+        if (infoIds && id != infoIds->cend()) {
+            xml.writeAttribute(attribute + "Ref", QString::number(id.value()));
+        } else {
+            xml.writeAttribute(attribute, info);
+        }
+    };
+
+    xml.writeStartElement("net");
+    xml.writeAttribute("name", name);
+    xml.writeAttribute("designation", attr.designation);
+    writeInfo("designationInfo", attr.designationInfo);
+    xml.writeAttribute("designationLineColor", attr.designationColor.name());
+    xml.writeAttribute("type", attr.type);
+    writeInfo("typeInfo", attr.typeInfo);
+    xml.writeAttribute("typeLineColor", attr.typeColor.name());
+    xml.writeAttribute("lineWidth", lineWidth);
+}
+
+quint64 SignalVisualizer::pinSetFingerprint(const QSet<QString>& pinIds) {
+    // Сумма перемешанных хешей не зависит от порядка пинов; отпечаток пишется в файлы схем,
+    // поэтому хеш должен совпадать на любой машине
+    quint64 fingerprint = 0;
+    for (const QString& pinId : pinIds) {
+        fingerprint += StableHash::mix(StableHash::string(pinId));
+    }
+    return fingerprint;
+}
+
+QSet<QString> SignalVisualizer::netPinIds(const NetConnections& net) const {
+    QSet<QString> pinIds;
+    pinIds.reserve(net.pinList.size());
+    for (Pin* pin : net.pinList) {
+        if (pin) pinIds.insert(pin->pinId());
+    }
+    return pinIds;
+}
+
+SignalVisualizer::ConfigMatchIndex SignalVisualizer::buildMatchIndex() const {
+    ConfigMatchIndex index;
+    index.fingerprints.reserve(m_netConnections.size());
+
+    QHash<QString, QSet<QString>> pinSets;
+    pinSets.reserve(m_netConnections.size());
+    for (auto it = m_netConnections.cbegin(); it != m_netConnections.cend(); ++it) {
+        QSet<QString> pinIds = netPinIds(it.value());
+        index.fingerprints.insert(pinSetFingerprint(pinIds), it.key());
+        pinSets.insert(it.key(), pinIds);
+    }
+
+    // Полные наборы пинов нужны только сетям с совпавшими отпечатками
+    for (auto it = index.fingerprints.cbegin(); it != index.fingerprints.cend(); ++it) {
+        if (index.fingerprints.count(it.key()) > 1) {
+            index.collisionPins.insert(it.value(), pinSets.value(it.value()));
+        }
+    }
+    return index;
+}
+
+QString SignalVisualizer::matchConfigNet(quint64 fingerprint, const ConfigMatchIndex& index, const std::function<QSet<QString>()>& pinIds) {
+    const QList<QString> candidates = index.fingerprints.values(fingerprint);
+    if (candidates.size() == 1) {
+        return candidates.first();
+    }
+
+    // Коллизия отпечатков: сравниваем наборы пинов целиком
+    const QSet<QString> configPins = candidates.isEmpty() ? QSet<QString>() : pinIds();
+    for (const QString& key : candidates) {
+        if (index.collisionPins.value(key) == configPins) {
+            return key;
+        }
+    }
+    return QString();
+}
+
+QList<SignalVisualizer::ConfigUpdate> SignalVisualizer::matchConfigNets(const QList<ConfigNet>& nets, const ConfigMatchIndex& index,
+                                                                        const std::atomic_bool* cancelled) {
+    QList<ConfigUpdate> updates;
+    for (const ConfigNet& configNet : nets) {
+        if (cancelled && cancelled->load()) return QList<ConfigUpdate>();
+        QString key = matchConfigNet(configNet.fingerprint, index, [&configNet]() { return configNet.pinIds; });
+        if (!key.isEmpty()) {
+            updates.append({key, configNet});
+        }
+    }
+    return updates;
+}
 
-        QString lineWidth = "1";
-        if (!connection.lineList.isEmpty()) {
-            lineWidth = QString::number(connection.lineList.first()->pen().widthF());
+QList<SignalVisualizer::ConfigUpdate> SignalVisualizer::matchConfigNets(const ColorSchemeBinaryReader& reader, const ConfigMatchIndex& index,
+                                                                        const std::atomic_bool* cancelled) {
+    QList<ConfigUpdate> updates;
+    for (int i = 0; i < reader.netCount(); ++i) {
+        if (cancelled && cancelled->load()) return QList<ConfigUpdate>();
+        // Сопоставление идёт по отпечатку записи, строки читаются только для найденных сетей
+        QString key = matchConfigNet(reader.fingerprint(i), index, [&reader, i]() { return reader.pinIds(i); });
+        if (!key.isEmpty()) {
+            updates.append({key, reader.configNet(i, false)});
         }
+    }
+    return updates;
+}
+
+SignalVisualizer::ConfigLoadResult SignalVisualizer::readConfigFile(const QString& fileName, const ConfigMatchIndex& index,
+                                                                   const std::atomic_bool* cancelled) {
+    ConfigLoadResult result;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        result.error = tr("Не удалось открыть файл %1:\n%2.").arg(fileName).arg(file.errorString());
+        return result;
+    }
 
-        result += "\n<net name=\"" + netName +
-                  "\" designation=\"" + connection.designation +
-                  "\" designationInfo=\"" + connection.designationInfo.toHtmlEscaped().replace("\n", "&#10;") +
-                  "\" designationLineColor=\"" + connection.designationColor.name() +
-                  "\" type=\"" + connection.type +
-                  "\" typeInfo=\"" + connection.typeInfo.toHtmlEscaped().replace("\n", "&#10;") +
-                  "\" typeLineColor=\"" + connection.typeColor.name() +
-                  "\" lineWidth=\"" + lineWidth + "\">\n";
+    // Формат определяется по сигнатуре, а не по расширению
+    if (ColorSchemeBinary::isBinaryFile(&file)) {
+        file.close();
 
-        for (Pin* pin : connection.pinList) {
-            if (pin)
-                result += "  <pin id=\"" + pin->pinId() + "\"/>\n";
+        ColorSchemeBinaryReader reader;
+        if (!reader.open(fileName)) {
+            result.error = tr("Не удалось прочитать файл %1:\n%2.").arg(fileName).arg(reader.errorString());
+            return result;
         }
+        result.updates = matchConfigNets(reader, index, cancelled);
+        return result;
+    }
 
-        result += "</net>\n";
+    // Сжатый файл распаковывается по блокам прямо в разборщик
+    CompressedDevice compressed(&file);
+    QIODevice* input = &file;
+    if (CompressedDevice::isCompressed(&file)) {
+        if (!compressed.open(QIODevice::ReadOnly)) {
+            result.error = tr("Не удалось прочитать файл %1:\n%2.").arg(fileName).arg(compressed.errorString());
+            return result;
+        }
+        input = &compressed;
     }
-    result += "</colorSchemeConfig>\n";
+
+    QXmlStreamReader xml(input);
+    QList<ConfigNet> nets;
+    if (!parseConfigXml(xml, nets, cancelled)) {
+        // Повреждённый сжатый поток обрывает XML, причину сообщает сам поток
+        const QString error = compressed.hasError() ? compressed.errorString() : xml.errorString();
+        result.error = tr("Ошибка в строке %1: %2").arg(xml.lineNumber()).arg(error);
+        return result;
+    }
+    result.updates = matchConfigNets(nets, index, cancelled);
     return result;
 }
 
+void SignalVisualizer::applyConfigNet(const ConfigNet& configNet, NetConnections& connection) {
+    const SignalAttributes& attr = configNet.attributes;
+    connection.designation = attr.designation;
+    connection.designationInfo = attr.designationInfo;
+    connection.type = attr.type;
+    connection.typeInfo = attr.typeInfo;
+    connection.designationColor = attr.designationColor;
+    connection.typeColor = attr.typeColor;
+    m_palette.setDesignationColor(connection.paletteSlot, attr.designationColor);
+    m_palette.setTypeColor(connection.paletteSlot, attr.typeColor);
+    applyThicknessToLineGroup(configNet.lineWidth, connection.lineList);
+}
+
 void SignalVisualizer::loadFromString(const QString &xmlString) {
     QXmlStreamReader xml(xmlString);
-    bool hasError = false;
+    QList<ConfigNet> nets;
+
+    if (!parseConfigXml(xml, nets)) {
+        SignalVisualizerWidget* parentWidget = qobject_cast<SignalVisualizerWidget*>(parent());
+        if (parentWidget) {
+            QMessageBox::warning(parentWidget, tr("Ошибка XML"), 
+                tr("Ошибка в строке %1: %2")
+                    .arg(xml.lineNumber())
+                    .arg(xml.errorString()));
+        }
+        return;
+    }
+    applyConfigNets(nets);
+}
+
+bool SignalVisualizer::parseConfigXml(QXmlStreamReader& xml, QList<ConfigNet>& nets, const std::atomic_bool* cancelled) {
+    QHash<int, QString> infoTable;
+    auto readInfo = [&infoTable](const QXmlStreamAttributes& attrs, const QString& attribute) {
+        if (attrs.hasAttribute(attribute + "Ref")) {
+            return infoTable.value(attrs.value(attribute + "Ref").toInt());
+        }
+        return attrs.value(attribute).toString();
+    };
 
     while (!xml.atEnd() && !xml.hasError()) {
+        // Отменённый разбор обрывается без ошибки, результат всё равно будет отброшен
+        if (cancelled && cancelled->load()) return true;
         QXmlStreamReader::TokenType token = xml.readNext();
 
-        if (token == QXmlStreamReader::StartElement && xml.name() == "net") {
+        if (token == QXmlStreamReader::StartElement && xml.name() == "info") {
+            QXmlStreamAttributes attrs = xml.attributes();
+            infoTable.insert(attrs.value("id").toInt(), attrs.value("text").toString());
+        } else if (token == QXmlStreamReader::StartElement && xml.name() == "net") {
             QXmlStreamAttributes attrs = xml.attributes();
-            QString netName = attrs.value("name").toString();
-            QString designation = attrs.value("designation").toString();
-            
-            // Добавляем чтение информации с заменой HTML-сущностей
-            QString designationInfo = attrs.value("designationInfo").toString()
-                .replace("&#10;", "\n")
-                .replace("&amp;", "&");
-            
-            QString type = attrs.value("type").toString();
-            
-            QString typeInfo = attrs.value("typeInfo").toString()
-                .replace("&#10;", "\n")
-                .replace("&amp;", "&");
-
-            QColor designationColor(attrs.value("designationLineColor").toString());
-            QColor typeColor(attrs.value("typeLineColor").toString());
-            int thickness = attrs.value("lineWidth").toInt();
-
-            QSet<QString> pinIds;
-            while (!(xml.tokenType() == QXmlStreamReader::EndElement && xml.name() == "net")) {
+            ConfigNet configNet;
+            configNet.name = attrs.value("name").toString();
+            configNet.attributes.designation = attrs.value("designation").toString();
+            // Сущности в атрибутах уже раскрыты QXmlStreamReader
+            configNet.attributes.designationInfo = readInfo(attrs, "designationInfo");
+            configNet.attributes.type = attrs.value("type").toString();
+            configNet.attributes.typeInfo = readInfo(attrs, "typeInfo");
+
+            configNet.attributes.designationColor = QColor(attrs.value("designationLineColor").toString());
+            configNet.attributes.typeColor = QColor(attrs.value("typeLineColor").toString());
+            configNet.lineWidth = attrs.value("lineWidth").toInt();
+
+            while (!xml.atEnd() && !(xml.tokenType() == QXmlStreamReader::EndElement && xml.name() == "net")) {
                 xml.readNext();
                 if (xml.tokenType() == QXmlStreamReader::StartElement && xml.name() == "pin") {
-                    pinIds.insert(xml.attributes().value("id").toString());
+                    configNet.pinIds.insert(xml.attributes().value("id").toString());
                 }
             }
+            if (xml.hasError()) break; // оборванная запись сети не применяется
 
-            // Обновляем данные соединения
-            for (auto &connection : m_netConnections) {
-                QSet<QString> currentPins;
-                for (Pin *pin : connection.pinList) {
-                    currentPins.insert(pin->pinId());
-                }
+            configNet.fingerprint = pinSetFingerprint(configNet.pinIds);
+            nets.append(configNet);
+        }
+    }
+    return !xml.hasError();
+}
 
-                if (currentPins == pinIds) {
-                    connection.designation = designation;
-                    connection.designationInfo = designationInfo;
-                    connection.type = type;
-                    connection.typeInfo = typeInfo;
-                    connection.designationColor = designationColor;
-                    connection.typeColor = typeColor;
-
-                    SignalVisualizerWidget* parentWidget = qobject_cast<SignalVisualizerWidget*>(parent());
-                    if (parentWidget && parentWidget->getView()->isShowingTypes()) {
-                        applyColorToLineGroup(typeColor, connection.lineList);
-                    } else {
-                        applyColorToLineGroup(designationColor, connection.lineList);
-                    }
-                    applyThicknessToLineGroup(thickness, connection.lineList);
-                    break;
-                }
-            }
+void SignalVisualizer::applyConfigNets(const QList<ConfigNet>& nets) {
+    commitConfigUpdates(matchConfigNets(nets, buildMatchIndex()));
+}
+
+void SignalVisualizer::loadFromBinary(const ColorSchemeBinaryReader& reader) {
+    commitConfigUpdates(matchConfigNets(reader, buildMatchIndex()));
+}
+
+void SignalVisualizer::loadConfigAsync(const QString& fileName) {
+    // Предыдущая загрузка не дожидается окончания: она видит флаг отмены на следующей сети
+    // и завершается сама, её результат отбрасывается
+    cancelConfigLoad();
+
+    // Индекс сетей строится в GUI-потоке, разбор файла и сопоставление идут в фоне
+    const ConfigMatchIndex index = buildMatchIndex();
+    auto cancelled = std::make_shared<std::atomic_bool>(false);
+    m_configLoadCancelled = cancelled;
+
+    disconnect(&m_configLoadWatcher, nullptr, this, nullptr);
+    connect(&m_configLoadWatcher, &QFutureWatcher<ConfigLoadResult>::finished, this, [this, cancelled, fileName]() {
+        if (cancelled->load()) return;
+
+        const ConfigLoadResult result = m_configLoadWatcher.result();
+        if (!result.error.isEmpty()) {
+            emit configLoadFailed(fileName, result.error);
+            return;
         }
+        commitConfigUpdates(result.updates);
+        emit configLoaded(fileName);
+    });
+
+    m_configLoadWatcher.setFuture(QtConcurrent::run([fileName, index, cancelled]() {
+        return readConfigFile(fileName, index, cancelled.get());
+    }));
+}
+
+void SignalVisualizer::cancelConfigLoad() {
+    if (m_configLoadCancelled) {
+        m_configLoadCancelled->store(true);
     }
+}
 
-    if (xml.hasError()) {
-        SignalVisualizerWidget* parentWidget = qobject_cast<SignalVisualizerWidget*>(parent());
-        if (parentWidget) {
-            QMessageBox::warning(parentWidget, tr("Ошибка XML"), 
-                tr("Ошибка в строке %1: %2")
-                    .arg(xml.lineNumber())
-                    .arg(xml.errorString()));
+bool SignalVisualizer::isLoadingConfig() const {
+    return m_configLoadWatcher.isRunning();
+}
+
+void SignalVisualizer::commitConfigUpdates(const QList<ConfigUpdate>& updates) {
+    // Загрузка схемы меняет толщину почти всех проводов сразу
+    beginStyleCommit();
+    for (const ConfigUpdate& update : updates) {
+        // Сеть могла исчезнуть, пока файл читался в фоне
+        auto it = m_netConnections.find(update.key);
+        if (it != m_netConnections.end()) {
+            applyConfigNet(update.net, it.value());
+            markChanged(CatalogChanged | StylesChanged, update.key);
         }
-        hasError = true;
     }
+    endStyleCommit();
+}
+
+QList<SignalVisualizer::ConfigNet> SignalVisualizer::configNets() const {
+    QList<ConfigNet> nets;
+    nets.reserve(m_netConnections.size());
+
+    for (auto it = m_netConnections.cbegin(); it != m_netConnections.cend(); ++it) {
+        nets.append(makeConfigNet(it.key(), it.value()));
+    }
+    return nets;
+}
+
+QList<SignalVisualizer::ConfigNet> SignalVisualizer::takeDirtyNets() {
+    QList<ConfigNet> nets;
+    for (auto it = m_netConnections.begin(); it != m_netConnections.end(); ++it) {
+        if (!it.value().dirty) continue;
 
-    if (!hasError) {
-        emit comboUpdated();
-        emit legendUpdated();
-        emit sceneUpdated();
+        nets.append(makeConfigNet(it.key(), it.value()));
+        it.value().dirty = false;
     }
+    return nets;
+}
+
+bool SignalVisualizer::hasDirtyNets() const {
+    for (const auto& connection : m_netConnections) {
+        if (connection.dirty) return true;
+    }
+    return false;
+}
+
+void SignalVisualizer::clearDirtyNets() {
+    for (auto& connection : m_netConnections) {
+        connection.dirty = false;
+    }
+}
+
+SignalVisualizer::ConfigNet SignalVisualizer::makeConfigNet(const QString& key, const NetConnections& connection) const {
+    ConfigNet configNet = netStyle(connection);
+    configNet.name = key;
+    configNet.pinIds = netPinIds(connection);
+    configNet.fingerprint = pinSetFingerprint(configNet.pinIds);
+    return configNet;
 }
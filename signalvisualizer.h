@@ -9,7 +9,13 @@
 #include <QDataStream>
 #include <QFile>
 #include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QBuffer>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include "circuit.h"
 #include "pin.h"
 #include "rail.h"
@@ -17,15 +23,30 @@
 #include "fixedvolt.h"
 #include "battery.h"
 #include "tunnel.h"
-#include "signalvisualizerview.h"
-#include "signalvisualizerwidget.h"
+#include "wireitem.h"
+#include "netsearchindex.h"
+#include "netbuilder.h"
+
+class ColorSchemeBinaryReader;
 
 class SignalVisualizer : public QObject
 {
     Q_OBJECT
     friend class SignalVisualizerView;
+    friend class NetSampler;
+    friend class SignalVisualizerBatch;
+    friend class NetTableModel;
 public:
     explicit SignalVisualizer(QObject *parent = nullptr);
+    ~SignalVisualizer();
+
+    // Что изменилось в модели с прошлого обновления представления
+    enum ChangeAspect {
+        CatalogChanged = 0x1,   // набор обозначений и типов или их цвета
+        StylesChanged = 0x2,    // оформление отдельных сетей
+        GeometryChanged = 0x4   // состав сетей
+    };
+    Q_DECLARE_FLAGS(ChangeAspects, ChangeAspect)
 
     struct NetConnections {
         QList<QGraphicsLineItem*> lineList;
@@ -37,6 +58,9 @@ public:
         QColor lineColor;
         QColor designationColor;
         QColor typeColor;
+        bool dirty = false; // изменена после последнего автосохранения
+        int paletteSlot = -1;
+        QString key;        // ключ в карте сетей, по нему сеть отмечается изменённой
         
         NetConnections() = default;
     
@@ -61,6 +85,46 @@ public:
         QString typeInfo;
     };
 
+    // Данные пина, достаточные для классификации без обращения к объектам схемы
+    struct NetPinInfo {
+        QString pinId;
+        QString compType;
+        double value = 0.0;
+    };
+
+    // Сеть, прочитанная из файла цветовой схемы
+    struct ConfigNet {
+        QString name;
+        SignalAttributes attributes;
+        int lineWidth = 0;
+        QSet<QString> pinIds;
+        quint64 fingerprint = 0;
+    };
+
+    // Найденная в схеме сеть и её сохранённые атрибуты
+    struct ConfigUpdate {
+        QString key;
+        ConfigNet net;
+    };
+
+    struct ConfigLoadResult {
+        QList<ConfigUpdate> updates;
+        QString error;
+    };
+
+    // Оформление сети до и после одной правки
+    struct NetStyleChange {
+        QString key;
+        ConfigNet before;
+        ConfigNet after;
+    };
+
+    // Данные текущих сетей для сопоставления вне GUI-потока
+    struct ConfigMatchIndex {
+        QMultiHash<quint64, QString> fingerprints;
+        QHash<QString, QSet<QString>> collisionPins;
+    };
+
     struct NetFlags {
         bool isSource = false;
         bool isRail = false;
@@ -106,11 +170,24 @@ public:
     QString getTypeInfoByGroup(const QList<QGraphicsLineItem*>& lineGroup) const;
     QString getPositionalDesignation(const QString &type);
     QList<QGraphicsLineItem*> getGroupByLine(QGraphicsLineItem* lineItem) const;
+    QString netKeyByLine(const QGraphicsLineItem* lineItem) const;
+
+    // Смежность компонентов и цепей, строится вместе с картой цепей
+    QStringList netsOfComponent(Component* component) const;
+    QList<Component*> componentsOfNet(const QString& key) const;
+    static QString componentName(Component* component);
+
+    // Индекс поиска цепей, обновляется вместе с рассылкой modelChanged
+    const NetSearchIndex& searchIndex() const { return m_searchIndex; }
 
     void removeDesignationForConnections(QString designation);
     void removeTypeForConnections(const QString& type);
     void resetConnectionsByGroup(const QList<QGraphicsLineItem*>& lineGroup);
 
+    // Правка нескольких сетей за один проход по модели и одну перестройку индекса сцены
+    void applyStyleToNets(const QStringList& keys, const SignalAttributes& attr, int lineWidth);
+    void resetNets(const QStringList& keys);
+
     void setDesignationByGroup(const QString& designation, QList<QGraphicsLineItem*>& lineGroup);
     void setDesignationInfoByGroup(const QString& info, QList<QGraphicsLineItem*>& lineGroup);
     void setTypeByGroup(const QString& type, QList<QGraphicsLineItem*>& lineGroup);
@@ -118,27 +195,67 @@ public:
     void setDesignationLineColorByGroup(QColor color, QList<QGraphicsLineItem*>& lineGroup);
     void setTypeLineColorByGroup(QColor color, QList<QGraphicsLineItem*>& lineGroup);
     
+    // Временная подсветка поверх цвета сети из палитры
     void applyColorToLineGroup(QColor color, QList<QGraphicsLineItem*>& lineGroup);
+    void clearColorOverride(const QList<QGraphicsLineItem*>& lineGroup);
     void applyThicknessToLineGroup(int thickness, const QList<QGraphicsLineItem*>& lineGroup);
 
+    // Пакет смены толщины: ширины копятся до end и применяются за одну перестройку индекса сцены
+    void beginStyleCommit();
+    void endStyleCommit();
+
+    // Правка оформления: между begin и end запоминаются исходные состояния затронутых сетей
+    void beginStyleEdit();
+    QList<NetStyleChange> endStyleEdit();
+    void applyNetStyles(const QList<ConfigUpdate>& styles);
+
     void updateNetColors(bool showCategories);
+    void setShowTypes(bool showCategories) { m_palette.setShowTypes(showCategories); }
+    const NetPalette* palette() const { return &m_palette; }
+    static QColor voltageGradientColor(double t);
     void updateConnectionsMap(Pin* startPin, Pin* endPin, QList<QGraphicsLineItem*>& lineItems);
+    void finishConnectionsMap();
     
     void colorizeCircuit();
+    void colorizeCircuitAsync();
+    void cancelColorize();
+    bool isColorizing() const;
 
-    QString toString();
+    // Полная запись сетей модели; сети сериализуются по одной, копия всей схемы не создаётся
+    bool writeConfig(QIODevice* device, bool infoTable = false) const;
     void loadFromString(const QString &xmlString);
+    void loadFromBinary(const ColorSchemeBinaryReader& reader);
+    void applyConfigNets(const QList<ConfigNet>& nets);
+    void loadConfigAsync(const QString& fileName);
+    void cancelConfigLoad();
+    bool isLoadingConfig() const;
+    QList<ConfigNet> configNets() const;
+    QList<ConfigNet> takeDirtyNets();
+    bool hasDirtyNets() const;
+    void clearDirtyNets();
+
+    static bool parseConfigXml(QXmlStreamReader& xml, QList<ConfigNet>& nets, const std::atomic_bool* cancelled = nullptr);
+    static void writeConfigXml(QIODevice* device, const QList<ConfigNet>& nets, bool infoTable = false);
+    static void writeConfigNet(QXmlStreamWriter& xml, const ConfigNet& configNet, const QHash<QString, int>* infoIds = nullptr);
+
+    static quint64 pinSetFingerprint(const QSet<QString>& pinIds);
+    QSet<QString> netPinIds(const NetConnections& net) const;
     
 signals:
-    void comboUpdated();
-    void legendUpdated();
+    // Изменения копятся и приходят одним сигналом за итерацию цикла событий
+    void modelChanged(SignalVisualizer::ChangeAspects aspects, const QSet<QString>& nets);
     void colorizeFinished();
-    void sceneUpdated();
+    void configLoaded(const QString& fileName);
+    void configLoadFailed(const QString& fileName, const QString& error);
 
 private:
     QMap<QString, NetConnections> m_netConnections;
     
     void assignVoltageGradientColors();
+    void assignPaletteSlots();
+    void buildComponentIndex();
+    void rebuildSearchIndex();
+    void indexNet(const QString& key, const NetConnections& net);
     QString formatVoltage(double value);
     bool hasPin(const QString& pinId, const QString& name);
     bool matchRegex(const QString& pinId, const QString& pattern);
@@ -150,24 +267,88 @@ private:
     void setDesignationInfo(const QString& info, NetConnections& net);
     void setTypeInfo(const QString& info, NetConnections& net);
 
-    void mergeDuplicateKeysNodes(QMap<QString, NetConnections>& mapNetConnections);
-    QString findMatchingKeyForPin(const QString& pinId, QMap<QString, NetConnections>& mapNetConnections);
-    QString findMatchingKeyForNodeConnection(const QString& pinId, QMap<QString, NetConnections>& mapNetConnections);
+    static void writeNetStart(QXmlStreamWriter& xml, const QString& name, const SignalAttributes& attr, const QString& lineWidth,
+                              const QHash<QString, int>* infoIds = nullptr);
+    static void writeInfoEntry(QXmlStreamWriter& xml, const QString& info, QHash<QString, int>& infoIds);
+
+    ConfigMatchIndex buildMatchIndex() const;
+    static QString matchConfigNet(quint64 fingerprint, const ConfigMatchIndex& index, const std::function<QSet<QString>()>& pinIds);
+    static QList<ConfigUpdate> matchConfigNets(const QList<ConfigNet>& nets, const ConfigMatchIndex& index,
+                                               const std::atomic_bool* cancelled = nullptr);
+    static QList<ConfigUpdate> matchConfigNets(const ColorSchemeBinaryReader& reader, const ConfigMatchIndex& index,
+                                               const std::atomic_bool* cancelled = nullptr);
+    static ConfigLoadResult readConfigFile(const QString& fileName, const ConfigMatchIndex& index, const std::atomic_bool* cancelled);
+    void commitConfigUpdates(const QList<ConfigUpdate>& updates);
+    void applyConfigNet(const ConfigNet& configNet, NetConnections& net);
+    ConfigNet makeConfigNet(const QString& key, const NetConnections& connection) const;
+    ConfigNet netStyle(const NetConnections& connection) const;
+    static bool sameStyle(const ConfigNet& a, const ConfigNet& b);
+    void touchNet(NetConnections& net, ChangeAspects aspects = StylesChanged);
+    void markChanged(ChangeAspects aspects, const QString& key = QString());
+    void flushChanges();
+
+    int m_styleEditDepth = 0;
+    QHash<QString, ConfigNet> m_styleEditBefore;
+
+    NetPalette m_palette;
+    QVector<QString> m_slotKeys;
+
+    // Индексы цепей - ячейки палитры
+    QHash<Component*, QVector<int>> m_componentNets;
+    QVector<QVector<Component*>> m_netComponents;
+
+    NetSearchIndex m_searchIndex;
+
+    int lineWidth(const QGraphicsLineItem* line) const;
+    static void setLineWidth(QGraphicsLineItem* line, int width);
+
+    int m_styleCommitDepth = 0;
+    QHash<QGraphicsLineItem*, int> m_pendingWidths;
+
+    ChangeAspects m_pendingAspects;
+    QSet<QString> m_pendingNets;
+    bool m_changesScheduled = false;
+
+    // Цепи при построении сцены собирает тот же NetBuilder, что и пакетная классификация;
+    // пины и провода сцены привязываются к готовым цепям в finishConnectionsMap
+    NetBuilder m_netBuilder;
+    QHash<QString, Pin*> m_builderPins;
+    QHash<QString, QList<QGraphicsLineItem*>> m_builderLines;
 
     QList<QString> m_systemTypes;
     QList<QString> m_systemDesignationsTypes;
 
-    QMap<QString, std::function<void(NetFlags&, double&, QString&, Component*, const QString&)>> m_sourceHandlers;
+    QMap<QString, std::function<void(NetFlags&, double&, QString&, const NetPinInfo&)>> m_sourceHandlers;
     QMap<QString, std::function<void(NetFlags&, const QString&)>> m_destHandlers;
-    QMap<QString, std::function<void(NetFlags&, QString&, Component*, const QString&)>> m_multiHandlers;
+    QMap<QString, std::function<void(NetFlags&, QString&, const QString&)>> m_multiHandlers;
     QMap<QString, QPair<QString, int>> m_posDesignation;
     QMap<QString, QString> m_typeToGroup;
 
-    void analyzePins(const NetConnections& net, NetFlags& flags, QString& designation);
+    QFutureWatcher<QHash<QString, SignalAttributes>> m_colorizeWatcher;
+    std::shared_ptr<std::atomic_bool> m_colorizeCancelled;
+
+    QFutureWatcher<ConfigLoadResult> m_configLoadWatcher;
+    std::shared_ptr<std::atomic_bool> m_configLoadCancelled;
+
+    QList<NetPinInfo> collectPinInfo(const NetConnections& net) const;
+    QHash<QString, QList<NetPinInfo>> snapshotNets() const;
+    SignalAttributes classifyNet(const QList<NetPinInfo>& pins);
+    QString classificationCacheFile() const;
+    QHash<QString, SignalAttributes> classifyWithCache(const QHash<QString, QList<NetPinInfo>>& snapshot,
+                                                       const QString& cacheFile, const std::atomic_bool* cancelled);
+    void commitClassification(const QHash<QString, SignalAttributes>& attributes);
+
+    void analyzePins(const QList<NetPinInfo>& pins, NetFlags& flags, QString& designation);
     void determineSignalType(const NetFlags& flags, const QString& designation, SignalAttributes& attr);
     void initControlSignal(SignalAttributes& attr, const QString& name, const QString& info);
     void initDataSignal(SignalAttributes& attr, const QString& name, const QString& info);
     void applyLineAppearance(const SignalAttributes& attr, NetConnections& net);
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(SignalVisualizer::ChangeAspects)
+
+// Представление и окно сами используют типы модели, поэтому подключаются после её объявления
+#include "signalvisualizerview.h"
+#include "signalvisualizerwidget.h"
+
 #endif // SIGNALVISUALIZER_H
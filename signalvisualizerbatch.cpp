@@ -0,0 +1,287 @@
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include "signalvisualizerbatch.h"
+#include "netbuilder.h"
+
+int SignalVisualizerBatch::run(const QStringList& arguments) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Классификация цепей схем без графического интерфейса");
+    parser.addHelpOption();
+    parser.addOption({"classify", "Пакетная классификация цепей."});
+    parser.addOption({{"f", "format"}, "Формат отчёта: cscfg или json.", "format", "cscfg"});
+    parser.addOption({{"o", "output-dir"}, "Каталог для отчётов.", "dir"});
+    parser.addOption({{"j", "jobs"}, "Число потоков обработки.", "count", "0"});
+    parser.addOption({"overwrite", "Заменять существующие отчёты."});
+    parser.addPositionalArgument("files", "Файлы схем.", "<circuit>...");
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if (!parser.parse(arguments)) {
+        err << parser.errorText() << "\n";
+        return 2;
+    }
+    if (parser.isSet("help") || parser.positionalArguments().isEmpty()) {
+        out << parser.helpText();
+        return parser.isSet("help") ? 0 : 2;
+    }
+
+    Options options;
+    const QString format = parser.value("format").toLower();
+    if (format == "json") options.format = Format::Json;
+    else if (format != "cscfg") {
+        err << "Неизвестный формат отчёта: " << format << "\n";
+        return 2;
+    }
+    options.outputDir = parser.value("output-dir");
+    options.jobs = parser.value("jobs").toInt();
+    options.overwrite = parser.isSet("overwrite");
+
+    if (!options.outputDir.isEmpty() && !QDir().mkpath(options.outputDir)) {
+        err << "Не удалось создать каталог " << options.outputDir << "\n";
+        return 2;
+    }
+
+    const QList<Result> results = classifyFiles(parser.positionalArguments(), options);
+
+    int failed = 0;
+    for (const Result& result : results) {
+        if (result.error.isEmpty()) {
+            out << "OK   " << result.circuitFile << " -> " << result.outputFile
+                << " (" << result.netCount << " цепей)\n";
+        } else {
+            err << "FAIL " << result.circuitFile << ": " << result.error << "\n";
+            ++failed;
+        }
+    }
+    out << results.size() - failed << "/" << results.size() << " схем обработано\n";
+    return failed == 0 ? 0 : 1;
+}
+
+bool SignalVisualizerBatch::handleCommandLine(const QStringList& arguments, int& exitCode) {
+    if (!arguments.contains("--classify")) return false;
+    exitCode = run(arguments);
+    return true;
+}
+
+QList<SignalVisualizerBatch::Result> SignalVisualizerBatch::classifyFiles(const QStringList& files, const Options& options) {
+    QThreadPool pool;
+    pool.setMaxThreadCount(options.jobs > 0 ? options.jobs : QThread::idealThreadCount());
+
+    QList<QFuture<Result>> futures;
+    futures.reserve(files.size());
+    for (const QString& file : files) {
+        futures.append(QtConcurrent::run(&pool, &SignalVisualizerBatch::classifyFile, file, options));
+    }
+
+    // Результаты возвращаются в порядке входных файлов
+    QList<Result> results;
+    results.reserve(futures.size());
+    for (QFuture<Result>& future : futures) {
+        results.append(future.result());
+    }
+    return results;
+}
+
+SignalVisualizerBatch::Result SignalVisualizerBatch::classifyFile(const QString& circuitFile, const Options& options) {
+    Result result;
+    result.circuitFile = circuitFile;
+    result.outputFile = outputFileName(circuitFile, options);
+    if (!options.overwrite && QFileInfo::exists(result.outputFile)) {
+        result.error = QObject::tr("Отчёт %1 уже существует").arg(result.outputFile);
+        return result;
+    }
+
+    CircuitData circuit;
+    if (!readCircuit(circuitFile, circuit, result.error)) {
+        return result;
+    }
+
+    const QList<SignalVisualizer::ConfigNet> nets = classifyCircuit(circuit);
+    result.netCount = nets.size();
+
+    if (options.format == Format::Json) {
+        writeJson(result.outputFile, circuitFile, nets, result.error);
+        return result;
+    }
+
+    QSaveFile file(result.outputFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        result.error = file.errorString();
+        return result;
+    }
+    SignalVisualizer::writeConfigXml(&file, nets);
+    if (!file.commit()) {
+        result.error = file.errorString();
+    }
+    return result;
+}
+
+bool SignalVisualizerBatch::readCircuit(const QString& fileName, CircuitData& circuit, QString& error) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+
+    QXmlStreamReader xml(&file);
+    while (!xml.atEnd() && !xml.hasError()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement || xml.name() != "item") continue;
+
+        QXmlStreamAttributes attrs = xml.attributes();
+        const QString type = attrs.value("itemtype").toString();
+
+        if (type == "Connector") {
+            const QString startId = attrs.value("startpinid").toString();
+            const QString endId = attrs.value("endpinid").toString();
+            if (!startId.isEmpty() && !endId.isEmpty()) {
+                circuit.connections.append({startId, endId});
+            }
+            continue;
+        }
+
+        // В разных версиях формата идентификатор компонента хранится в разных атрибутах
+        QString id = attrs.value("CircId").toString();
+        if (id.isEmpty()) id = attrs.value("objectName").toString();
+        if (id.isEmpty()) continue;
+
+        circuit.componentTypes.insert(id, type);
+        for (const QString& name : {"Voltage", "volt"}) {
+            if (attrs.hasAttribute(name)) {
+                circuit.componentValues.insert(id, parseValue(attrs.value(name).toString()));
+                break;
+            }
+        }
+    }
+
+    if (xml.hasError()) {
+        error = QString("%1: %2").arg(xml.lineNumber()).arg(xml.errorString());
+        return false;
+    }
+    return true;
+}
+
+QString SignalVisualizerBatch::componentId(const QString& pinId, const CircuitData& circuit) {
+    // Идентификатор пина - "<компонент>-<пин>", а в имени компонента тоже бывают дефисы
+    for (int dash = pinId.lastIndexOf('-'); dash > 0; dash = pinId.lastIndexOf('-', dash - 1)) {
+        const QString id = pinId.left(dash);
+        if (circuit.componentTypes.contains(id)) return id;
+    }
+    return QString();
+}
+
+double SignalVisualizerBatch::parseValue(const QString& text) {
+    // "5 V", "3.3", "500 mV"
+    static const QRegularExpression regex(R"(^\s*([+-]?\d+(?:\.\d+)?)\s*([pnuµmkM]?))");
+    QRegularExpressionMatch match = regex.match(text);
+    if (!match.hasMatch()) return 0.0;
+
+    double value = match.captured(1).toDouble();
+    const QString prefix = match.captured(2);
+    if (prefix == "p") value *= 1e-12;
+    else if (prefix == "n") value *= 1e-9;
+    else if (prefix == "u" || prefix == "µ") value *= 1e-6;
+    else if (prefix == "m") value *= 1e-3;
+    else if (prefix == "k") value *= 1e3;
+    else if (prefix == "M") value *= 1e6;
+    return value;
+}
+
+QList<SignalVisualizer::ConfigNet> SignalVisualizerBatch::classifyCircuit(const CircuitData& circuit) {
+    NetBuilder builder;
+    for (const auto& connection : circuit.connections) {
+        builder.addConnection(connection.first, connection.second);
+    }
+
+    // Модель без виджета: используются только правила классификации
+    SignalVisualizer model;
+    const QMap<QString, QStringList>& nets = builder.nets();
+
+    for (auto it = nets.cbegin(); it != nets.cend(); ++it) {
+        QList<SignalVisualizer::NetPinInfo> pins;
+        pins.reserve(it.value().size());
+        for (const QString& pinId : it.value()) {
+            const QString id = componentId(pinId, circuit);
+            if (id.isEmpty()) continue;
+
+            SignalVisualizer::NetPinInfo info;
+            info.pinId = pinId;
+            info.compType = circuit.componentTypes.value(id);
+            info.value = circuit.componentValues.value(id, 0.0);
+            pins.append(info);
+        }
+
+        SignalVisualizer::NetConnections& connection = model.m_netConnections[it.key()];
+        connection.key = it.key();
+        model.applyLineAppearance(model.classifyNet(pins), connection);
+    }
+    model.assignVoltageGradientColors();
+
+    QList<SignalVisualizer::ConfigNet> result;
+    result.reserve(nets.size());
+    for (auto it = nets.cbegin(); it != nets.cend(); ++it) {
+        const SignalVisualizer::NetConnections& connection = model.m_netConnections.value(it.key());
+
+        SignalVisualizer::ConfigNet configNet;
+        configNet.name = it.key();
+        configNet.attributes = {connection.designation, connection.designationColor, connection.designationInfo,
+                                connection.type, connection.typeColor, connection.typeInfo};
+        configNet.lineWidth = 3;
+        configNet.pinIds = QSet<QString>(it.value().begin(), it.value().end());
+        configNet.fingerprint = SignalVisualizer::pinSetFingerprint(configNet.pinIds);
+        result.append(configNet);
+    }
+    return result;
+}
+
+bool SignalVisualizerBatch::writeJson(const QString& fileName, const QString& circuitFile,
+                                      const QList<SignalVisualizer::ConfigNet>& nets, QString& error) {
+    QJsonArray netArray;
+    for (const SignalVisualizer::ConfigNet& net : nets) {
+        QStringList pinIds = net.pinIds.values();
+        pinIds.sort();
+
+        QJsonObject object;
+        object["name"] = net.name;
+        object["designation"] = net.attributes.designation;
+        object["designationColor"] = net.attributes.designationColor.name();
+        object["designationInfo"] = net.attributes.designationInfo;
+        object["type"] = net.attributes.type;
+        object["typeColor"] = net.attributes.typeColor.name();
+        object["typeInfo"] = net.attributes.typeInfo;
+        object["pins"] = QJsonArray::fromStringList(pinIds);
+        netArray.append(object);
+    }
+
+    QJsonObject root;
+    root["circuit"] = QFileInfo(circuitFile).fileName();
+    root["nets"] = netArray;
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    if (!file.commit()) {
+        error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QString SignalVisualizerBatch::outputFileName(const QString& circuitFile, const Options& options) {
+    QFileInfo info(circuitFile);
+    const QString dir = options.outputDir.isEmpty() ? info.absolutePath() : options.outputDir;
+    const QString suffix = options.format == Format::Json ? ".classified.json" : ".classified.cscfg";
+    return QDir(dir).filePath(info.completeBaseName() + suffix);
+}
@@ -0,0 +1,65 @@
+#ifndef SIGNALVISUALIZERBATCH_H
+#define SIGNALVISUALIZERBATCH_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include "signalvisualizer.h"
+
+// Классификация цепей без окна: чтение файла схемы, сборка цепей по пинам проводников,
+// классификация и запись отчёта .cscfg или JSON. Файлы обрабатываются параллельно.
+//
+// Вызов из main приложения до создания окна:
+//   int exitCode = 0;
+//   if (SignalVisualizerBatch::handleCommandLine(app.arguments(), exitCode)) return exitCode;
+// Из окна визуализатора тот же разбор доступен через «Файл > Пакетная классификация схем...».
+class SignalVisualizerBatch {
+public:
+    enum class Format {
+        Cscfg,
+        Json
+    };
+
+    struct Options {
+        Format format = Format::Cscfg;
+        QString outputDir;  // пусто - рядом с файлом схемы
+        int jobs = 0;       // 0 - по числу ядер
+        bool overwrite = false; // без него существующий отчёт не заменяется
+    };
+
+    struct Result {
+        QString circuitFile;
+        QString outputFile;
+        int netCount = 0;
+        QString error;
+    };
+
+    static int run(const QStringList& arguments);
+    // true, если командная строка требует пакетного режима; тогда exitCode - результат run()
+    static bool handleCommandLine(const QStringList& arguments, int& exitCode);
+
+    static QList<Result> classifyFiles(const QStringList& files, const Options& options);
+    static Result classifyFile(const QString& circuitFile, const Options& options);
+
+    // Отчёт получает суффикс .classified, чтобы не совпасть с цветовой схемой, сохранённой из окна
+    static QString outputFileName(const QString& circuitFile, const Options& options);
+
+private:
+    struct CircuitData {
+        QHash<QString, QString> componentTypes;
+        QHash<QString, double> componentValues;
+        QList<QPair<QString, QString>> connections;
+    };
+
+    static bool readCircuit(const QString& fileName, CircuitData& circuit, QString& error);
+    static QString componentId(const QString& pinId, const CircuitData& circuit);
+    static double parseValue(const QString& text);
+
+    static QList<SignalVisualizer::ConfigNet> classifyCircuit(const CircuitData& circuit);
+    static bool writeJson(const QString& fileName, const QString& circuitFile,
+                          const QList<SignalVisualizer::ConfigNet>& nets, QString& error);
+};
+
+#endif // SIGNALVISUALIZERBATCH_H
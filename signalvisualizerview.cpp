@@ -15,9 +15,13 @@
 #include <QMessageBox>
 #include <QPainter>
 #include <QApplication>
+#include <QRubberBand>
 #include "signalvisualizerview.h"
 #include "signalvisualizerwidget.h"
 #include "proxyitem.h"
+#include "netsampler.h"
+#include "netstylecommand.h"
+#include "wireitem.h"
 
 SignalVisualizerView::SignalVisualizerView(SignalVisualizerWidget* signalVisualizerWidget, QWidget *parent)
     : QGraphicsView(parent),
@@ -25,40 +29,153 @@ SignalVisualizerView::SignalVisualizerView(SignalVisualizerWidget* signalVisuali
     m_scaleFactor(1.15),
     m_hoveredItem(nullptr) {
     
-    connect(m_signalVisualizerWidget->getModel(), &SignalVisualizer::colorizeFinished, this, &SignalVisualizerView::updateLegend);
-    connect(m_signalVisualizerWidget->getModel(), &SignalVisualizer::colorizeFinished,
-    this, [this]() {
-        m_signalVisualizerWidget->getModel() -> updateNetColors(m_showTypes);
+    connect(m_signalVisualizerWidget->getModel(), &SignalVisualizer::modelChanged,
+    this, [this](SignalVisualizer::ChangeAspects aspects, const QSet<QString>& nets) {
+        refreshFromModel(aspects, nets);
     });
-    connect(m_signalVisualizerWidget->getModel(), &SignalVisualizer::legendUpdated, this, &SignalVisualizerView::updateLegend);
-    connect(m_signalVisualizerWidget->getModel(), &SignalVisualizer::comboUpdated, this, &SignalVisualizerView::updateDesignationCombo);
-    connect(m_signalVisualizerWidget->getModel(), &SignalVisualizer::comboUpdated, this, &SignalVisualizerView::updateTypeCombo);
 
     m_circuitInstance = signalVisualizerWidget -> getCircuit();
+    m_netSampler = new NetSampler(m_signalVisualizerWidget->getModel(), this);
+    connect(m_netSampler, &NetSampler::netsChanged, this, &SignalVisualizerView::applyLiveColors);
     createEditor();
     applyStyles();
     
     fillItemsForColorComboBox(m_designationColorCombo);
     fillItemsForColorComboBox(m_typeColorCombo);
 
-    displayConnecors(m_circuitInstance);
-    displayComponents(m_circuitInstance);
-    displayNodes(m_circuitInstance);
-    signalVisualizerWidget -> getModel() -> colorizeCircuit();
+    startStagedBuild();
+}
+
+void SignalVisualizerView::startStagedBuild() {
+    if (!m_circuitInstance) return;
+
+    m_pendingConnectors.clear();
+    m_pendingComponents.clear();
+    m_pendingNodes.clear();
+    for (Connector* conn : *m_circuitInstance->conList()) m_pendingConnectors.append(conn);
+    for (Component* comp : *m_circuitInstance->compList()) m_pendingComponents.append(comp);
+    for (Node* node : *m_circuitInstance->nodeList()) m_pendingNodes.append(node);
+
+    m_buildStage = BuildStage::Connectors;
+    m_buildIndex = 0;
+    m_buildProgress = 0;
+
+    m_progressOverlay->setRange(0, m_pendingConnectors.size() + m_pendingComponents.size() + m_pendingNodes.size() + 1);
+    m_progressOverlay->setValue(0);
+    m_progressOverlay->show();
+    updateProgressOverlayPosition();
+
+    connect(m_signalVisualizerWidget->getModel(), &SignalVisualizer::colorizeFinished,
+            this, &SignalVisualizerView::finishBuild, Qt::UniqueConnection);
+    m_buildTimer->start();
+}
+
+void SignalVisualizerView::processBuildSlice() {
+    QElapsedTimer sliceTimer;
+    sliceTimer.start();
+
+    while (sliceTimer.elapsed() < m_buildSliceMs) {
+        if (m_buildStage == BuildStage::Connectors) {
+            if (m_buildIndex < m_pendingConnectors.size()) {
+                displayConnector(m_pendingConnectors[m_buildIndex++]);
+            } else {
+                m_buildStage = BuildStage::Components;
+                m_buildIndex = 0;
+                m_pendingConnectors.clear();
+                m_signalVisualizerWidget->getModel()->finishConnectionsMap();
+                // Провода готовы: показываем их в нейтральном цвете до окончания классификации
+                break;
+            }
+        } else if (m_buildStage == BuildStage::Components) {
+            if (m_buildIndex < m_pendingComponents.size()) {
+                displayComponent(m_pendingComponents[m_buildIndex++]);
+            } else {
+                m_buildStage = BuildStage::Nodes;
+                m_buildIndex = 0;
+                m_pendingComponents.clear();
+            }
+        } else if (m_buildStage == BuildStage::Nodes) {
+            if (m_buildIndex < m_pendingNodes.size()) {
+                displayNode(m_pendingNodes[m_buildIndex++]);
+            } else {
+                m_buildStage = BuildStage::Classification;
+                m_buildIndex = 0;
+                m_pendingNodes.clear();
+                m_signalVisualizerWidget->getModel()->colorizeCircuitAsync();
+            }
+        } else {
+            break;
+        }
+        ++m_buildProgress;
+    }
+
+    m_progressOverlay->setValue(m_buildProgress);
+    scheduleProxyMaterialization();
+
+    if (m_buildStage == BuildStage::Classification || m_buildStage == BuildStage::Done) {
+        m_buildTimer->stop();
+    }
+}
+
+void SignalVisualizerView::finishBuild() {
+    if (m_buildStage != BuildStage::Classification) return;
+
+    m_buildStage = BuildStage::Done;
+    m_progressOverlay->setValue(m_progressOverlay->maximum());
+    m_progressOverlay->hide();
+    scheduleProxyMaterialization();
+}
+
+void SignalVisualizerView::cancelBuild() {
+    if (m_buildStage == BuildStage::Done) return;
+
+    m_buildTimer->stop();
+    // Уже показанные провода остаются привязанными к цепям
+    if (m_buildStage == BuildStage::Connectors) m_signalVisualizerWidget->getModel()->finishConnectionsMap();
+    m_signalVisualizerWidget->getModel()->cancelColorize();
+    m_pendingConnectors.clear();
+    m_pendingComponents.clear();
+    m_pendingNodes.clear();
+    m_buildStage = BuildStage::Done;
+    m_progressOverlay->hide();
+}
+
+void SignalVisualizerView::updateProgressOverlayPosition() {
+    int margin = 10;
+    int w = qMin(300, width() - 2 * margin);
+    m_progressOverlay->setGeometry((width() - w) / 2, margin, w, 20);
 }
 
 void SignalVisualizerView::createEditor() {
     m_tooltipLabel = new QLabel(this);
     m_tooltipLabel->setVisible(false);
 
-    m_legendOverlay = new QWidget(this);
+    m_progressOverlay = new QProgressBar(this);
+    m_progressOverlay->setFormat("Построение схемы... %p%");
+    m_progressOverlay->setTextVisible(true);
+    m_progressOverlay->hide();
+
+    m_buildTimer = new QTimer(this);
+    m_buildTimer->setInterval(0);
+    connect(m_buildTimer, &QTimer::timeout, this, &SignalVisualizerView::processBuildSlice);
 
-    m_layout = new QVBoxLayout(m_legendOverlay);
-    m_layout->setContentsMargins(10, 10, 10, 10);
-    m_layout->setSpacing(5);
-    m_legendOverlay->setLayout(m_layout);
+    m_legendOverlay = new LegendWidget(this);
     m_legendOverlay->hide();
 
+    m_rubberBand = new QRubberBand(QRubberBand::Rectangle, viewport());
+
+    // Снимок для миникарты собирается с задержкой, чтобы серия правок давала одну перерисовку
+    m_minimap = new MinimapWidget(this);
+    m_minimap->setFixedSize(220, 160);
+    m_minimap->hide();
+    connect(m_minimap, &MinimapWidget::navigateRequested, this, [this](const QPointF& scenePos) {
+        centerOn(scenePos);
+    });
+    m_minimapTimer = new QTimer(this);
+    m_minimapTimer->setSingleShot(true);
+    m_minimapTimer->setInterval(250);
+    connect(m_minimapTimer, &QTimer::timeout, this, &SignalVisualizerView::updateMinimapSnapshot);
+
     m_checkboxOverlay = new QWidget(this);
     m_checkboxLayout = new QVBoxLayout(m_checkboxOverlay);
     m_checkboxLayout->setContentsMargins(5, 5, 5, 5);
@@ -80,7 +197,7 @@ void SignalVisualizerView::createEditor() {
             this, &SignalVisualizerView::toggleCompLabelVisibility);
 
     m_lineEditOverlay = new QWidget(this);
-    m_lineEditOverlay->setFixedSize(300, 300);
+    m_lineEditOverlay->setFixedSize(300, 340);
     m_lineEditOverlay->move(width() - 220, 10);
     m_lineEditLayout = new QFormLayout(m_lineEditOverlay);
     m_lineEditOverlay->setLayout(m_lineEditLayout);
@@ -118,6 +235,11 @@ void SignalVisualizerView::createEditor() {
     m_typeInfoEdit = new QTextEdit(m_lineEditOverlay);
     m_lineEditLayout->addRow("Информация о типе:", m_typeInfoEdit);
 
+    m_netComponentsLabel = new QLabel(m_lineEditOverlay);
+    m_netComponentsLabel->setWordWrap(true);
+    m_netComponentsLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_lineEditLayout->addRow("Компоненты цепи:", m_netComponentsLabel);
+
     m_thicknessSpin = new QSpinBox(m_lineEditOverlay);
     m_thicknessSpin->setRange(1, 10);
     m_thicknessSpin->setValue(3);
@@ -140,7 +262,6 @@ void SignalVisualizerView::createEditor() {
 
 void SignalVisualizerView::applyStyles() {
     m_tooltipLabel->setStyleSheet("background-color: white; border: 1px solid black; padding: 5px;");
-    m_legendOverlay->setStyleSheet("background-color: white; border: 1px solid black;");
     m_checkboxOverlay->setStyleSheet("background-color: white; border: 1px solid black;");
     m_checkboxOverlay->setStyleSheet(R"(
         QCheckBox { spacing: 8px; font-size: 12px; }
@@ -358,9 +479,9 @@ void SignalVisualizerView::signalDesignationsManager() {
             if (mainIndex != -1) {
                 m_signalDesignationCombo->removeItem(mainIndex);
                 designationsCombo->removeItem(designationsCombo->currentIndex());
+                m_signalVisualizerWidget-> getModel()->beginStyleEdit();
                 m_signalVisualizerWidget-> getModel()->removeDesignationForConnections(current);
-                updateLegend();
-                updateDesignationCombo();
+                pushStyleEdit(QString("Удаление обозначения \"%1\"").arg(current));
                 m_signalTypeCombo->setCurrentIndex(-1);
                 m_typeColorCombo->setCurrentIndex(-1);
 
@@ -429,10 +550,9 @@ void SignalVisualizerView::signalTypesManager() {
             if (mainIndex != -1) {
                 m_signalDesignationCombo->removeItem(mainIndex);
                 typeCombo->removeItem(typeCombo->currentIndex());
+                m_signalVisualizerWidget-> getModel()->beginStyleEdit();
                 m_signalVisualizerWidget-> getModel()->removeTypeForConnections(current);
-                updateLegend();
-                updateDesignationCombo();
-                updateTypeCombo();
+                pushStyleEdit(QString("Удаление типа \"%1\"").arg(current));
                 m_signalTypeCombo->setCurrentIndex(-1);
                 m_typeColorCombo->setCurrentIndex(-1);
                 m_signalDesignationCombo->setCurrentIndex(-1);
@@ -520,38 +640,55 @@ void SignalVisualizerView::wheelEvent(QWheelEvent *event) {
     } else {
         scale(1.0 / m_scaleFactor, 1.0 / m_scaleFactor);
     }
+    scheduleProxyMaterialization();
+    updateMinimapViewport();
 }
 
 void SignalVisualizerView::mousePressEvent(QMouseEvent *event) {
     if (event->button() == Qt::LeftButton) {
         QPointF scenePos = mapToScene(event->pos());
         QGraphicsLineItem* foundLine = nullptr;
+        MainComponentProxyItem* foundComponent = nullptr;
         QRectF pickArea(scenePos.x() - 2, scenePos.y() - 2, 4, 4);
 
+        // Провода имеют приоритет над компонентом под ними
         const auto items = scene()->items(pickArea, Qt::IntersectsItemShape, Qt::DescendingOrder);
         for (QGraphicsItem* item : items) {
             if (QGraphicsLineItem* line = dynamic_cast<QGraphicsLineItem*>(item)) {
                 foundLine = line;
                 break;
             }
+            if (!foundComponent) {
+                foundComponent = dynamic_cast<MainComponentProxyItem*>(item->topLevelItem());
+            }
         }
-        if (foundLine) {
-            QList<QGraphicsLineItem*> newLineGroup = m_signalVisualizerWidget->getModel() ->getGroupByLine(foundLine);
-            if (m_selectedLineItem && newLineGroup != m_selectedLineGroup) {
-                deselectLine(m_selectedLineGroup);
-                m_selectedLineGroup.clear();
+        const bool extend = event->modifiers() & Qt::ShiftModifier;
+        if (!foundLine && foundComponent) {
+            // Щелчок по компоненту выделяет все цепи, подключённые к его пинам
+            QStringList nets = extend ? m_selectedNets : QStringList();
+            for (const QString& key : m_signalVisualizerWidget->getModel()->netsOfComponent(foundComponent->component())) {
+                if (!nets.contains(key)) nets.append(key);
+            }
+            m_selectedLineItem = nullptr;
+            setSelectedNets(nets);
+        } else if (foundLine) {
+            QString key = m_signalVisualizerWidget->getModel()->netKeyByLine(foundLine);
+            QStringList nets = m_selectedNets;
+            if (!extend) {
+                nets = QStringList{key};
+            } else if (!nets.removeOne(key)) {
+                // Shift добавляет цепь к выделению или снимает с неё выделение
+                nets.append(key);
             }
             m_selectedLineItem = foundLine;
-            m_selectedLineGroup = newLineGroup;
-            selectLine(m_selectedLineGroup);
+            setSelectedNets(nets);
         } else {
-            if (m_selectedLineItem) {
-
-                deselectLine(m_selectedLineGroup);
-                m_selectedLineGroup.clear();
-                m_selectedLineItem = nullptr;
-            }
-            hideEditor();
+            // Протяжка по пустому месту выделяет цепи рамкой
+            if (!extend) setSelectedNets(QStringList());
+            m_rubberBandOrigin = event->pos();
+            m_isRubberBanding = true;
+            m_rubberBand->setGeometry(QRect(m_rubberBandOrigin, QSize()));
+            m_rubberBand->show();
         }
     } else if (event->button() == Qt::MiddleButton) {
         m_isPanning = true;
@@ -562,7 +699,9 @@ void SignalVisualizerView::mousePressEvent(QMouseEvent *event) {
 }
 
 void SignalVisualizerView::mouseMoveEvent(QMouseEvent *event) {
-    if (m_isPanning) {
+    if (m_isRubberBanding) {
+        m_rubberBand->setGeometry(QRect(m_rubberBandOrigin, event->pos()).normalized());
+    } else if (m_isPanning) {
         QPoint delta = event->pos() - m_lastMousePosition;
         m_lastMousePosition = event->pos();
         horizontalScrollBar()->setValue(horizontalScrollBar()->value() - delta.x());
@@ -606,12 +745,18 @@ void SignalVisualizerView::mouseReleaseEvent(QMouseEvent *event) {
     if (event->button() == Qt::MiddleButton) {
         m_isPanning = false;
         setCursor(Qt::ArrowCursor);
+    } else if (event->button() == Qt::LeftButton && m_isRubberBanding) {
+        m_isRubberBanding = false;
+        m_rubberBand->hide();
+        selectNetsInRect(m_rubberBand->geometry(), event->modifiers() & Qt::ShiftModifier);
     }
     QGraphicsView::mouseReleaseEvent(event);
 }
 
 void SignalVisualizerView::focusOutEvent(QFocusEvent *event) {
     m_isPanning = false;
+    m_isRubberBanding = false;
+    m_rubberBand->hide();
     setCursor(Qt::ArrowCursor);
     QGraphicsView::focusOutEvent(event);
 }
@@ -621,6 +766,98 @@ void SignalVisualizerView::resizeEvent(QResizeEvent *event) {
     updateOverlayPosition();
     updateCheckboxOverlayPosition();
     updateEditorOverlayPosition();
+    updateProgressOverlayPosition();
+    updateMinimapPosition();
+    scheduleProxyMaterialization();
+    updateMinimapViewport();
+}
+
+void SignalVisualizerView::scrollContentsBy(int dx, int dy) {
+    QGraphicsView::scrollContentsBy(dx, dy);
+    scheduleProxyMaterialization();
+    updateMinimapViewport();
+}
+
+void SignalVisualizerView::setProxyItemBudget(int budget) {
+    m_proxyItemBudget = qMax(0, budget);
+    scheduleProxyMaterialization();
+}
+
+void SignalVisualizerView::scheduleProxyMaterialization() {
+    if (m_materializePending) return;
+    m_materializePending = true;
+    QTimer::singleShot(0, this, &SignalVisualizerView::materializeVisibleProxies);
+}
+
+void SignalVisualizerView::materializeVisibleProxies() {
+    m_materializePending = false;
+    if (!scene()) return;
+
+    QRectF visibleRect = mapToScene(viewport()->rect()).boundingRect();
+    const auto items = scene()->items(visibleRect, Qt::IntersectsItemBoundingRect);
+    ++m_materializePass;
+
+    for (QGraphicsItem* item : items) {
+        MainComponentProxyItem* proxy = dynamic_cast<MainComponentProxyItem*>(item);
+        if (!proxy) continue;
+
+        if (proxy->isMaterialized()) {
+            // Видимый прокси отмечается номером прохода, порядок вытеснения считается только при нехватке бюджета
+            auto entry = m_materializedProxies.find(proxy);
+            if (entry != m_materializedProxies.end()) entry->lastVisible = m_materializePass;
+        } else {
+            const int cost = proxy->materializePinItems();
+            m_materializedItemCount += cost;
+            m_materializedProxies.insert(proxy, {proxy, cost, m_materializePass});
+
+            // Прокси удаляется вместе с компонентом или сценой, его стоимость снимается здесь же
+            connect(proxy, &QObject::destroyed, this, &SignalVisualizerView::proxyDestroyed, Qt::UniqueConnection);
+        }
+    }
+
+    evictProxies(visibleRect);
+}
+
+void SignalVisualizerView::evictProxies(const QRectF& visibleRect) {
+    if (m_materializedItemCount <= m_proxyItemBudget) return;
+
+    QVector<MaterializedProxy> candidates;
+    for (const MaterializedProxy& entry : m_materializedProxies) {
+        if (!entry.proxy->sceneBoundingRect().intersects(visibleRect)) candidates.append(entry);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const MaterializedProxy& a, const MaterializedProxy& b) {
+        return a.lastVisible < b.lastVisible;
+    });
+
+    for (const MaterializedProxy& entry : candidates) {
+        if (m_materializedItemCount <= m_proxyItemBudget) break;
+        m_materializedItemCount -= entry.proxy->releasePinItems();
+        m_materializedProxies.remove(entry.proxy);
+    }
+}
+
+void SignalVisualizerView::proxyDestroyed(QObject* proxy) {
+    // Удалённый прокси больше не учитывается ни в бюджете, ни в очереди вытеснения
+    m_materializedItemCount -= m_materializedProxies.take(proxy).cost;
+}
+
+void SignalVisualizerView::renderSceneForExport(QPainter* painter, const QRectF& target, const QRectF& source) {
+    // Свёрнутые прокси разворачиваются только на время отрисовки, бюджет окна не меняется
+    QList<MainComponentProxyItem*> expanded;
+    const auto items = scene()->items(source, Qt::IntersectsItemBoundingRect);
+    for (QGraphicsItem* item : items) {
+        MainComponentProxyItem* proxy = dynamic_cast<MainComponentProxyItem*>(item);
+        if (!proxy || proxy->isMaterialized()) continue;
+
+        proxy->materializePinItems();
+        expanded.append(proxy);
+    }
+
+    scene()->render(painter, target, source);
+
+    for (MainComponentProxyItem* proxy : expanded) {
+        proxy->releasePinItems();
+    }
 }
 
 void SignalVisualizerView::setLegend(const QVector<LegendItem> &items) {
@@ -637,48 +874,33 @@ void SignalVisualizerView::updateLegendOverlay() {
         m_legendOverlay->hide();
         return;
     }
-    delete m_legendOverlay->layout();
-    m_layout = new QVBoxLayout(m_legendOverlay);
-    m_layout->setContentsMargins(0, 0, 0, 0);
-    m_layout->setSpacing(5);
-
-    for (const LegendItem &item : m_legendItems) {
-        QLabel *colorLabel = new QLabel();
-        colorLabel->setFixedSize(20, 20);
-        colorLabel->setStyleSheet(
-            QString("background-color: %1; border: 1px solid black;").arg(item.color.name()));
-
-        QLabel *textLabel = new QLabel(item.label);
-        textLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
-
-        QHBoxLayout *itemLayout = new QHBoxLayout();
-        itemLayout->addWidget(colorLabel);
-        itemLayout->addWidget(textLabel);
-        m_layout->addLayout(itemLayout);
-    }
 
-    m_legendOverlay->setLayout(m_layout);
-    m_legendOverlay->show();
-    qApp->processEvents();
-    m_legendOverlay->adjustSize();
-    updateOverlayPosition();
+    // Раскладка пересчитывается только при изменении набора записей
+    if (m_legendOverlay->setEntries(m_legendItems) || m_legendOverlay->isHidden()) {
+        m_legendOverlay->show();
+        updateOverlayPosition();
+    }
 }
 
 void SignalVisualizerView::updateLegend() {
-    m_legendItems.clear();
-    QSet<QPair<QString, QColor>> items;
+    // Легенды обоих режимов собираются за один проход, переключение режима выбирает готовую
+    QSet<QPair<QString, QColor>> designations;
+    QSet<QPair<QString, QColor>> types;
     for (const auto &net : m_signalVisualizerWidget -> getModel()-> m_netConnections) {
-        if (isShowingTypes()) {
-            if (!net.type.isEmpty() && net.typeColor.isValid()) {
-                items.insert({net.type, net.typeColor});
-            }
-        } else {
-            if (!net.designation.isEmpty() && net.designationColor.isValid()) {
-                items.insert({net.designation, net.designationColor});
-            }
+        if (!net.type.isEmpty() && net.typeColor.isValid()) {
+            types.insert({net.type, net.typeColor});
+        }
+        if (!net.designation.isEmpty() && net.designationColor.isValid()) {
+            designations.insert({net.designation, net.designationColor});
         }
     }
 
+    m_designationLegend = sortedLegend(designations);
+    m_typeLegend = sortedLegend(types);
+    setLegend(m_showTypes ? m_typeLegend : m_designationLegend);
+}
+
+QVector<SignalVisualizerView::LegendItem> SignalVisualizerView::sortedLegend(const QSet<QPair<QString, QColor>>& items) {
     QList<QPair<QColor, QString>> sortedItems;
     for (const auto& item : items) {
         sortedItems.append(qMakePair(item.second, item.first));
@@ -698,10 +920,12 @@ void SignalVisualizerView::updateLegend() {
             return a.first.lightness() < b.first.lightness();
         });
 
+    QVector<LegendItem> legend;
+    legend.reserve(sortedItems.size());
     for (const auto& item : sortedItems) {
-        m_legendItems.append({item.first, item.second});
+        legend.append({item.first, item.second});
     }
-    setLegend(m_legendItems);
+    return legend;
 }
 
 void SignalVisualizerView::updateOverlayPosition() {
@@ -723,30 +947,123 @@ void SignalVisualizerView::updateCheckboxOverlayPosition() {
     m_checkboxOverlay->setGeometry(x, y, size.width(), size.height());
 }
 
+void SignalVisualizerView::updateMinimapPosition() {
+    int margin = 10;
+    m_minimap->move(margin, margin);
+}
+
+void SignalVisualizerView::setMinimapVisible(bool visible) {
+    m_minimapEnabled = visible;
+    if (!visible) {
+        m_minimapTimer->stop();
+        m_minimap->hide();
+        return;
+    }
+    updateMinimapSnapshot();
+}
+
+void SignalVisualizerView::updateMinimapSnapshot() {
+    if (!m_minimapEnabled || !scene()) return;
+
+    SignalVisualizer* model = m_signalVisualizerWidget -> getModel();
+    MinimapWidget::Snapshot snapshot;
+
+    // Провода берутся с цветом сети из палитры, без подсветки выделения
+    for (const auto& net : model -> m_netConnections) {
+        for (QGraphicsLineItem* line : net.lineList) {
+            const QLineF sceneLine(line->mapToScene(line->line().p1()), line->mapToScene(line->line().p2()));
+            WireItem* wire = dynamic_cast<WireItem*>(line);
+            const bool hasSlot = wire && model -> palette() -> hasSlot(wire->paletteSlot());
+
+            snapshot.lines.append(sceneLine);
+            snapshot.colors.append(hasSlot ? model -> palette() -> color(wire->paletteSlot()) : line->pen().color());
+            snapshot.widths.append(line->pen().widthF());
+            snapshot.sceneRect |= QRectF(sceneLine.p1(), sceneLine.p2()).normalized();
+        }
+    }
+    for (QGraphicsItem* item : scene()->items()) {
+        if (!dynamic_cast<MainComponentProxyItem*>(item)) continue;
+        snapshot.components.append(item->sceneBoundingRect());
+        snapshot.sceneRect |= snapshot.components.last();
+    }
+
+    if (snapshot.sceneRect.isEmpty()) {
+        m_minimap->hide();
+        return;
+    }
+
+    m_minimap->setSnapshot(snapshot);
+    if (m_minimap->isHidden()) {
+        updateMinimapPosition();
+        m_minimap->show();
+    }
+    updateMinimapViewport();
+}
+
+void SignalVisualizerView::updateMinimapViewport() {
+    // Перерисовывается только рамка на миникарте
+    if (m_minimap->isHidden()) return;
+    m_minimap->setViewportRect(mapToScene(viewport()->rect()).boundingRect());
+}
+
 void SignalVisualizerView::toggleDisplayMode(bool showCategories) {
     m_showTypes = showCategories;
-    updateLegend();
+    setLegend(m_showTypes ? m_typeLegend : m_designationLegend);
+    if (m_minimapEnabled) m_minimapTimer->start();
 
-    for (auto it = m_signalVisualizerWidget -> getModel()->m_netConnections.begin(); it != m_signalVisualizerWidget -> getModel()->m_netConnections.end(); ++it) {
-        const QList<QGraphicsLineItem*>& lines = it.value().lineList;
+    // Провода берут цвет из активной палитры при отрисовке, обходить сети не нужно
+    m_signalVisualizerWidget -> getModel() -> setShowTypes(m_showTypes);
+    viewport()->update();
 
-        QColor colorToApply;
-        if (showCategories) {
-            colorToApply = it.value().typeColor.isValid() ? it.value().typeColor : Qt::gray;
-        } else {
-            colorToApply = it.value().designationColor.isValid() ? it.value().designationColor : Qt::gray;
-        }
+    if (isLiveMode()) {
+        // Перезапуск опроса перекрашивает все цепи по текущему состоянию симуляции
+        m_netSampler->start();
+    }
+}
 
-        for (QGraphicsLineItem* line : lines) {
-            if (line) {
-                QPen pen = line->pen();
-                pen.setColor(colorToApply);
-                line->setPen(pen);
-            }
+bool SignalVisualizerView::isLiveMode() const {
+    return m_netSampler->isActive();
+}
+
+void SignalVisualizerView::setLiveMode(bool enabled) {
+    if (enabled == isLiveMode()) return;
+
+    if (enabled) {
+        m_netSampler->start();
+    } else {
+        m_netSampler->stop();
+        m_signalVisualizerWidget->getModel()->updateNetColors(m_showTypes);
+        if (!m_selectedLineGroup.isEmpty()) {
+            m_signalVisualizerWidget->getModel()->applyColorToLineGroup(QColorConstants::Svg::orange, m_selectedLineGroup);
         }
     }
 }
 
+bool SignalVisualizerView::startVcdCapture(const QString& fileName, QString* error) {
+    return m_netSampler->startCapture(fileName, error);
+}
+
+bool SignalVisualizerView::stopVcdCapture(QString* error) {
+    return m_netSampler->stopCapture(error);
+}
+
+void SignalVisualizerView::setLiveSamplingMode(int mode) {
+    m_netSampler->setMode(static_cast<NetSampler::Mode>(mode));
+}
+
+void SignalVisualizerView::applyLiveColors(const QHash<QString, QColor>& colors) {
+    auto& connections = m_signalVisualizerWidget->getModel()->m_netConnections;
+
+    for (auto it = colors.cbegin(); it != colors.cend(); ++it) {
+        auto net = connections.find(it.key());
+        if (net == connections.end() || net->lineList.isEmpty()) continue;
+        // Выделенная цепь остаётся подсвеченной
+        if (m_selectedLineGroup.contains(net->lineList.first())) continue;
+
+        m_signalVisualizerWidget->getModel()->applyColorToLineGroup(it.value(), net->lineList);
+    }
+}
+
 void SignalVisualizerView::toggleCompLabelVisibility(int state) {
     bool checked = (state == Qt::Checked);
     if (checked) {
@@ -783,11 +1100,89 @@ void SignalVisualizerView::updateEditorOverlayPosition() {
     m_lineEditOverlay->move(newX, newY);
 }
 
+void SignalVisualizerView::setSelectedNets(const QStringList& keys) {
+    SignalVisualizer* model = m_signalVisualizerWidget -> getModel();
+
+    deselectLine(m_selectedLineGroup);
+    m_selectedNets.clear();
+    m_selectedLineGroup.clear();
+    for (const QString& key : keys) {
+        auto net = model -> m_netConnections.constFind(key);
+        if (net == model -> m_netConnections.cend() || m_selectedNets.contains(key)) continue;
+
+        m_selectedNets.append(key);
+        m_selectedLineGroup.append(net->lineList);
+    }
+
+    if (m_selectedNets.isEmpty()) {
+        m_selectedLineItem = nullptr;
+        hideEditor();
+        return;
+    }
+
+    model -> applyColorToLineGroup(QColorConstants::Svg::orange, m_selectedLineGroup);
+
+    // Редактор заполняется по первой выделенной цепи
+    QList<QGraphicsLineItem*> anchorGroup = model -> m_netConnections.value(m_selectedNets.first()).lineList;
+    selectLine(anchorGroup);
+    updateNetComponentsLabel(m_selectedNets.first());
+}
+
+void SignalVisualizerView::updateNetComponentsLabel(const QString& key) {
+    QStringList names;
+    for (Component* comp : m_signalVisualizerWidget -> getModel() -> componentsOfNet(key)) {
+        names.append(SignalVisualizer::componentName(comp));
+    }
+    names.sort();
+    m_netComponentsLabel->setText(names.isEmpty() ? QString("-") : names.join(", "));
+}
+
+void SignalVisualizerView::focusNet(const QString& key) {
+    QRectF bounds = m_signalVisualizerWidget -> getModel() -> searchIndex().bounds(key);
+    if (bounds.isNull()) return;
+
+    setSelectedNets(QStringList{key});
+
+    // Короткую цепь показываем с окружением, а не во весь экран
+    const qreal minSize = 200.0;
+    const qreal margin = qMax(bounds.width(), bounds.height()) * 0.1 + 20.0;
+    bounds.adjust(-margin, -margin, margin, margin);
+    if (bounds.width() < minSize || bounds.height() < minSize) {
+        const QPointF center = bounds.center();
+        bounds.setSize(QSizeF(qMax(bounds.width(), minSize), qMax(bounds.height(), minSize)));
+        bounds.moveCenter(center);
+    }
+    fitInView(bounds, Qt::KeepAspectRatio);
+    scheduleProxyMaterialization();
+    updateMinimapViewport();
+}
+
+void SignalVisualizerView::selectNetsInRect(const QRect& viewRect, bool extend) {
+    // Случайный сдвиг мыши при щелчке по пустому месту рамкой не считается
+    if (viewRect.width() < 3 && viewRect.height() < 3) return;
+
+    SignalVisualizer* model = m_signalVisualizerWidget -> getModel();
+    QStringList nets = extend ? m_selectedNets : QStringList();
+    QSet<QString> seen(nets.begin(), nets.end());
+
+    // Поиск кандидатов идёт по индексу сцены, ключ цепи берётся по ячейке палитры провода
+    const QRectF sceneRect = mapToScene(viewRect).boundingRect();
+    const auto items = scene()->items(sceneRect, Qt::IntersectsItemShape, Qt::AscendingOrder);
+    for (QGraphicsItem* item : items) {
+        QGraphicsLineItem* line = dynamic_cast<QGraphicsLineItem*>(item);
+        if (!line) continue;
+
+        QString key = model -> netKeyByLine(line);
+        if (key.isEmpty() || seen.contains(key)) continue;
+        seen.insert(key);
+        nets.append(key);
+    }
+    setSelectedNets(nets);
+}
+
 void SignalVisualizerView::selectLine(QList<QGraphicsLineItem*>& lineGroup) {
-    m_selectedLineGroup = lineGroup;
     if (!lineGroup.isEmpty()) {
         m_lineEditOverlay->show();
-        m_signalVisualizerWidget -> getModel() -> applyColorToLineGroup(QColorConstants::Svg::orange,lineGroup);
 
         QString lineDesignation = m_signalVisualizerWidget -> getModel()->getDesignationByGroup(lineGroup);
         int designationIndex = m_signalDesignationCombo->findText(lineDesignation);
@@ -831,10 +1226,7 @@ void SignalVisualizerView::selectLine(QList<QGraphicsLineItem*>& lineGroup) {
 }
 
 void SignalVisualizerView::deselectLine(QList<QGraphicsLineItem*>& lineGroup) {
-    if (!lineGroup.isEmpty()) {
-        QColor originalColor = m_signalVisualizerWidget -> getModel() -> getLineColorByGroup(lineGroup, isShowingTypes());
-        m_signalVisualizerWidget -> getModel() -> applyColorToLineGroup(originalColor,lineGroup);
-    }
+    m_signalVisualizerWidget -> getModel() -> clearColorOverride(lineGroup);
 }
 
 void SignalVisualizerView::resetSelection() {
@@ -847,8 +1239,9 @@ void SignalVisualizerView::resetSelection() {
     );
 
     if (reply == QMessageBox::Yes) {
-        m_signalVisualizerWidget -> getModel() -> resetConnectionsByGroup(m_selectedLineGroup);
-        updateLegend();
+        m_signalVisualizerWidget -> getModel() -> beginStyleEdit();
+        m_signalVisualizerWidget -> getModel() -> resetNets(m_selectedNets);
+        pushStyleEdit("Сброс цепи");
         m_signalDesignationCombo->setCurrentIndex(-1);
         m_designationColorCombo->setCurrentIndex(-1);
         m_designationInfoEdit->clear();
@@ -862,6 +1255,7 @@ void SignalVisualizerView::resetSelection() {
 void SignalVisualizerView::clearSelection() {
     m_selectedLineItem = nullptr;
     m_selectedLineGroup.clear();
+    m_selectedNets.clear();
 }
 
 void SignalVisualizerView::hideEditor() {
@@ -895,14 +1289,18 @@ void SignalVisualizerView::applyChanges() {
     QString newTypeInfo = m_typeInfoEdit->toPlainText();
     int newThickness = m_thicknessSpin->value();
 
-    bool isSystemType = m_signalVisualizerWidget->getModel()->isSystemType(newType);
-    bool isSystemDesignationType = m_signalVisualizerWidget->getModel()->isSystemDesignationType(newType);
-    QString oldType = m_signalVisualizerWidget->getModel()->getTypeByGroup(m_selectedLineGroup);
-    QColor oldTypeColor = m_signalVisualizerWidget->getModel()->getLineColorByGroup(m_selectedLineGroup, true);
-    QColor oldDesignationColor = m_signalVisualizerWidget->getModel()->getLineColorByGroup(m_selectedLineGroup, false);
-    
-    if (isSystemType && (newTypeColor != oldTypeColor)) errors << "цвет типа";
-    if (isSystemType && isSystemDesignationType && (newDesignationColor != oldDesignationColor)) errors << "цвет обозначения";
+    SignalVisualizer* model = m_signalVisualizerWidget->getModel();
+    bool isSystemType = model->isSystemType(newType);
+    bool isSystemDesignationType = model->isSystemDesignationType(newType);
+
+    if (isSystemType) {
+        for (const QString& key : m_selectedNets) {
+            const SignalVisualizer::NetConnections& net = model->m_netConnections.value(key);
+            if (newTypeColor != net.typeColor && !errors.contains("цвет типа")) errors << "цвет типа";
+            if (isSystemDesignationType && newDesignationColor != net.designationColor
+                && !errors.contains("цвет обозначения")) errors << "цвет обозначения";
+        }
+    }
     if (!errors.isEmpty()) {
         QMessageBox::warning(
             this,
@@ -912,39 +1310,88 @@ void SignalVisualizerView::applyChanges() {
         return;
     }
 
-    m_signalVisualizerWidget -> getModel() -> setDesignationByGroup(newDesignation, m_selectedLineGroup);
-    m_signalVisualizerWidget -> getModel() -> setTypeByGroup(newType, m_selectedLineGroup);
-    m_signalVisualizerWidget -> getModel() -> setDesignationLineColorByGroup(newDesignationColor, m_selectedLineGroup);
-    m_signalVisualizerWidget -> getModel() -> setTypeLineColorByGroup(newTypeColor, m_selectedLineGroup);
-    m_signalVisualizerWidget -> getModel() -> setDesignationInfoByGroup(newDesignationInfo, m_selectedLineGroup);
-    m_signalVisualizerWidget -> getModel() -> setTypeInfoByGroup(newTypeInfo, m_selectedLineGroup);
+    SignalVisualizer::SignalAttributes attributes{
+        newDesignation, newDesignationColor, newDesignationInfo,
+        newType, newTypeColor, newTypeInfo
+    };
 
-    if (m_showTypes) {
-        m_signalVisualizerWidget -> getModel() -> applyColorToLineGroup(newTypeColor, m_selectedLineGroup);
-    } else {
-        m_signalVisualizerWidget -> getModel() -> applyColorToLineGroup(newDesignationColor, m_selectedLineGroup);
-    }
-    m_signalVisualizerWidget -> getModel() -> applyThicknessToLineGroup(newThickness, m_selectedLineGroup);
+    // Все выделенные цепи меняются одним проходом по модели и одной записью в стеке отмены
+    const int count = m_selectedNets.size();
+    model -> beginStyleEdit();
+    model -> applyStyleToNets(m_selectedNets, attributes, newThickness);
+    pushStyleEdit(count > 1 ? QString("Изменение цепей (%1)").arg(count) : QString("Изменение цепи"));
 
-    updateLegend();
-    deselectLine(m_selectedLineGroup);
-    clearSelection();
-    m_signalVisualizerWidget -> getModel() -> updateNetColors(m_showTypes);
-    hideEditor();
+    // Цвета затронутых сетей и легенда обновятся одним отложенным проходом
+    setSelectedNets(QStringList());
+}
+
+void SignalVisualizerView::pushStyleEdit(const QString& text) {
+    // В стек попадают только сети, оформление которых действительно изменилось
+    QList<SignalVisualizer::NetStyleChange> changes = m_signalVisualizerWidget -> getModel() -> endStyleEdit();
+    if (changes.isEmpty()) return;
+
+    m_signalVisualizerWidget -> getUndoStack() -> push(
+        new NetStyleCommand(m_signalVisualizerWidget -> getModel(), changes, text));
 }
 
 void SignalVisualizerView::updateDesignationCombo() {
     QList<QString> newItems = m_signalVisualizerWidget -> getModel() -> getExtractedDesignations();
 
+    // Обновление приходит отложенно и не должно сбивать выбор в открытом редакторе
+    QSignalBlocker blocker(m_signalDesignationCombo);
+    const QString current = m_signalDesignationCombo->currentIndex() == -1 ? QString() : m_signalDesignationCombo->currentText();
     m_signalDesignationCombo->clear();
     m_signalDesignationCombo->addItems(newItems);
+    m_signalDesignationCombo->setCurrentIndex(current.isEmpty() ? -1 : m_signalDesignationCombo->findText(current));
 }
 
 void SignalVisualizerView::updateTypeCombo() {
     QList<QString> newItems = m_signalVisualizerWidget -> getModel() -> getExtractedCategories();
 
+    QSignalBlocker blocker(m_signalTypeCombo);
+    const QString current = m_signalTypeCombo->currentIndex() == -1 ? QString() : m_signalTypeCombo->currentText();
     m_signalTypeCombo->clear();
     m_signalTypeCombo->addItems(newItems);
+    m_signalTypeCombo->setCurrentIndex(current.isEmpty() ? -1 : m_signalTypeCombo->findText(current));
+}
+
+void SignalVisualizerView::refreshFromModel(SignalVisualizer::ChangeAspects aspects, const QSet<QString>& nets) {
+    SignalVisualizer* model = m_signalVisualizerWidget -> getModel();
+
+    if (aspects & SignalVisualizer::CatalogChanged) {
+        updateDesignationCombo();
+        updateTypeCombo();
+    }
+    if (aspects & (SignalVisualizer::CatalogChanged | SignalVisualizer::GeometryChanged)) {
+        updateLegend();
+    }
+
+    if (m_minimapEnabled && (aspects & (SignalVisualizer::StylesChanged | SignalVisualizer::GeometryChanged))) {
+        m_minimapTimer->start();
+    }
+
+    // В режиме реального времени цвета линий задаёт опрос симуляции
+    if (isLiveMode()) return;
+
+    if (aspects & SignalVisualizer::GeometryChanged) {
+        model -> updateNetColors(m_showTypes);
+        if (!m_selectedLineGroup.isEmpty()) {
+            model -> applyColorToLineGroup(QColorConstants::Svg::orange, m_selectedLineGroup);
+        }
+        return;
+    }
+
+    if (!(aspects & SignalVisualizer::StylesChanged)) return;
+
+    // Палитра уже обновлена, перерисовываются только провода изменённых сетей
+    for (const QString& key : nets) {
+        auto net = model -> m_netConnections.find(key);
+        if (net == model -> m_netConnections.end()) continue;
+
+        for (QGraphicsLineItem* line : net->lineList) {
+            line->update();
+        }
+    }
 }
 
 void SignalVisualizerView::setCompLabelVisibility(bool visible) {
@@ -970,74 +1417,84 @@ void SignalVisualizerView::displayConnecors(Circuit* circuit) {
 
     const QList<Connector*>* connectors = circuit->conList();
     for (Connector* conn : *connectors) {
-        if (conn) {
-            QStringList pointList = conn->pointList();
-            if (!pointList.isEmpty()) {
-                QVector<QPointF> points;
-
-                // Преобразование точек из строки в координаты
-                for (int i = 0; i < pointList.size(); i += 2) {
-                    points.append(QPointF(pointList[i].toDouble(), pointList[i + 1].toDouble()));
-                }
+        displayConnector(conn);
+    }
+}
 
-                Pin* startPin = conn->startPin();
-                Pin* endPin = conn->endPin();
-
-                if (startPin && endPin) {
-                    QColor lineColor = Qt::darkGreen;
-                    QPen pen(lineColor, 3, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
-                    
-                    Component* startComp = dynamic_cast<Component*>(startPin->parentItem());
-                    Component* endComp = dynamic_cast<Component*>(endPin->parentItem());
-                    if (!startComp || !endComp) {
-                        qWarning() << "Parent is not a Component!";
-                        continue;
-                    }
-                    QString startPinId = startPin -> pinId();
-                    QString endPinId = endPin -> pinId();
-
-                    QList<QGraphicsLineItem*> lineItems;
-
-                    for (int i = 0; i < points.size() - 1; ++i) {
-                        if (points[i] != points[i + 1]) {
-                            bool duplicateLine = false;
-                            for (auto& item : lineItems) {
-                                if (item->line().p1() == points[i] && item->line().p2() == points[i + 1]) {
-                                    duplicateLine = true;
-                                    break;
-                                }
-                            }
+QGraphicsLineItem* SignalVisualizerView::addWire(const QLineF& line, const QPen& pen) {
+    WireItem* wire = new WireItem(line, pen, m_signalVisualizerWidget->getModel()->palette());
+    m_signalVisualizerWidget->m_scene->addItem(wire);
+    return wire;
+}
+
+void SignalVisualizerView::displayConnector(Connector* conn) {
+    if (conn) {
+        QStringList pointList = conn->pointList();
+        if (!pointList.isEmpty()) {
+            QVector<QPointF> points;
+
+            // Преобразование точек из строки в координаты
+            for (int i = 0; i < pointList.size(); i += 2) {
+                points.append(QPointF(pointList[i].toDouble(), pointList[i + 1].toDouble()));
+            }
+
+            Pin* startPin = conn->startPin();
+            Pin* endPin = conn->endPin();
+
+            if (startPin && endPin) {
+                QColor lineColor = Qt::darkGreen;
+                QPen pen(lineColor, 3, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
 
-                            if (!duplicateLine) {
-                                QGraphicsLineItem* lineItem = m_signalVisualizerWidget->m_scene->addLine(QLineF(points[i], points[i + 1]), pen);
-                                lineItem->setZValue(ZLevel::Lines);
-                                lineItems.append(lineItem);
+                Component* startComp = dynamic_cast<Component*>(startPin->parentItem());
+                Component* endComp = dynamic_cast<Component*>(endPin->parentItem());
+                if (!startComp || !endComp) {
+                    qWarning() << "Parent is not a Component!";
+                    return;
+                }
+                QString startPinId = startPin -> pinId();
+                QString endPinId = endPin -> pinId();
+
+                QList<QGraphicsLineItem*> lineItems;
+
+                for (int i = 0; i < points.size() - 1; ++i) {
+                    if (points[i] != points[i + 1]) {
+                        bool duplicateLine = false;
+                        for (auto& item : lineItems) {
+                            if (item->line().p1() == points[i] && item->line().p2() == points[i + 1]) {
+                                duplicateLine = true;
+                                break;
                             }
                         }
-                    }
 
-                    QPointF start = startPin->scenePos();
-                    QPointF end = endPin->scenePos();
-                    if (!pointList.isEmpty()) {
-                        QPointF firstPoint(pointList[0].toDouble(), pointList[1].toDouble());
-                        if (start != firstPoint) {
-                            QGraphicsLineItem* lineItem = m_signalVisualizerWidget->m_scene->addLine(QLineF(start, firstPoint), pen);
+                        if (!duplicateLine) {
+                            QGraphicsLineItem* lineItem = addWire(QLineF(points[i], points[i + 1]), pen);
                             lineItem->setZValue(ZLevel::Lines);
                             lineItems.append(lineItem);
                         }
                     }
-                    if (pointList.size() > 2) {
-                        QPointF lastPoint(pointList[pointList.size() - 2].toDouble(),
-                                          pointList[pointList.size() - 1].toDouble());
-                        if (end != lastPoint) {
-                            QGraphicsLineItem* lineItem = m_signalVisualizerWidget->m_scene->addLine(QLineF(lastPoint, end), pen);
-                            lineItem->setZValue(ZLevel::Lines);
-                            lineItems.append(lineItem);
-                        }
+                }
+
+                QPointF start = startPin->scenePos();
+                QPointF end = endPin->scenePos();
+                if (!pointList.isEmpty()) {
+                    QPointF firstPoint(pointList[0].toDouble(), pointList[1].toDouble());
+                    if (start != firstPoint) {
+                        QGraphicsLineItem* lineItem = addWire(QLineF(start, firstPoint), pen);
+                        lineItem->setZValue(ZLevel::Lines);
+                        lineItems.append(lineItem);
+                    }
+                }
+                if (pointList.size() > 2) {
+                    QPointF lastPoint(pointList[pointList.size() - 2].toDouble(),
+                                      pointList[pointList.size() - 1].toDouble());
+                    if (end != lastPoint) {
+                        QGraphicsLineItem* lineItem = addWire(QLineF(lastPoint, end), pen);
+                        lineItem->setZValue(ZLevel::Lines);
+                        lineItems.append(lineItem);
                     }
-                    // Создание (обновление) карты соединений
-                    m_signalVisualizerWidget -> getModel() -> updateConnectionsMap(startPin, endPin, lineItems);
                 }
+                // Создание (обновление) карты соединений
+                m_signalVisualizerWidget -> getModel() -> updateConnectionsMap(startPin, endPin, lineItems);
             }
         }
     }
@@ -1048,19 +1505,20 @@ void SignalVisualizerView::displayComponents(Circuit* circuit) {
 
     const QList<Component*>* components = circuit->compList();
     for (Component* comp : *components) {
-        if (comp) {
-            QPointF scenePos = comp->scenePos();
-            QRectF boundingRect = comp->mapRectToScene(comp->boundingRect());
-
-            MainComponentProxyItem* proxyItem = new MainComponentProxyItem(comp, this);
-            proxyItem->setZValue(ZLevel::Components);
-            m_signalVisualizerWidget->m_scene->addItem(proxyItem);
-
-            ComponentOverlayTextItem* overlayItem = new ComponentOverlayTextItem(comp, this);
-            overlayItem->setZValue(ZLevel::Labels);
-            m_signalVisualizerWidget->m_scene->addItem(overlayItem);
-            m_overlayItems.append(overlayItem);
-        }
+        displayComponent(comp);
+    }
+}
+
+void SignalVisualizerView::displayComponent(Component* comp) {
+    if (comp) {
+        MainComponentProxyItem* proxyItem = new MainComponentProxyItem(comp, this);
+        proxyItem->setZValue(ZLevel::Components);
+        m_signalVisualizerWidget->m_scene->addItem(proxyItem);
+
+        ComponentOverlayTextItem* overlayItem = new ComponentOverlayTextItem(comp, this);
+        overlayItem->setZValue(ZLevel::Labels);
+        m_signalVisualizerWidget->m_scene->addItem(overlayItem);
+        m_overlayItems.append(overlayItem);
     }
 }
 
@@ -1069,8 +1527,14 @@ void SignalVisualizerView::displayNodes(Circuit* circuit) {
 
     const QList<Node*>* nodes = circuit->nodeList();
     for (Node* node : *nodes) {
-        NodeProxyItem* proxyItem = new NodeProxyItem(node);
-        proxyItem->setZValue(ZLevel::Nodes);
-        m_signalVisualizerWidget->m_scene->addItem(proxyItem);
+        displayNode(node);
     }
 }
+
+void SignalVisualizerView::displayNode(Node* node) {
+    if (!node) return;
+
+    NodeProxyItem* proxyItem = new NodeProxyItem(node);
+    proxyItem->setZValue(ZLevel::Nodes);
+    m_signalVisualizerWidget->m_scene->addItem(proxyItem);
+}
@@ -20,7 +20,13 @@
 #include <QGraphicsDropShadowEffect>
 #include <QTextEdit>
 #include <QtMath>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QProgressBar>
 #include <unordered_set>
+#include "legendwidget.h"
+#include "minimapwidget.h"
 #include "circuit.h"
 #include "pin.h"
 #include "mcu.h"
@@ -34,9 +40,14 @@
 #include "plotbase.h"
 #include "logiccomponent.h"
 #include "node.h"
+#include "connector.h"
+#include "signalvisualizer.h"
 
 class SignalVisualizerWidget;
 class ComponentOverlayTextItem;
+class MainComponentProxyItem;
+class NetSampler;
+class QRubberBand;
 
 inline uint qHash(const QColor &color, uint seed = 0) noexcept {
     return qHash(color.rgba(), seed);
@@ -58,10 +69,16 @@ class SignalVisualizerView : public QGraphicsView {
     friend class SubComponentProxyItem;
     friend class ComponentOverlayTextItem;
     friend class PinProxyItem;
+    friend class SchematicExporter;
 
-    struct LegendItem {
-        QColor color;
-        QString label;
+    using LegendItem = LegendWidget::Entry;
+
+    enum class BuildStage {
+        Connectors,
+        Components,
+        Nodes,
+        Classification,
+        Done
     };
 
 public:
@@ -70,6 +87,23 @@ public:
     bool isShowingTypes() const { return m_showTypes; }
     void toggleDisplayModeExternal() { toggleDisplayMode(!m_showTypes); }
 
+    // Лимит одновременно существующих прокси пинов и подписей
+    void setProxyItemBudget(int budget);
+    int proxyItemBudget() const { return m_proxyItemBudget; }
+
+    bool isBuilding() const { return m_buildStage != BuildStage::Done; }
+    void cancelBuild();
+
+    bool isLiveMode() const;
+    bool startVcdCapture(const QString& fileName, QString* error = nullptr);
+    bool stopVcdCapture(QString* error = nullptr);
+
+    // Выделить цепь и показать её целиком
+    void focusNet(const QString& key);
+
+    void setMinimapVisible(bool visible);
+    bool isMinimapVisible() const { return m_minimapEnabled; }
+
 public slots:
     void toggleDisplayMode(bool showCategories);
     void setCompLabelVisibility(bool visible);
@@ -77,6 +111,8 @@ public slots:
     void setCompPosDesignationVisibility(bool visible);
     void updateDesignationCombo();
     void updateTypeCombo();
+    void setLiveMode(bool enabled);
+    void setLiveSamplingMode(int mode);
 
 protected:
     void wheelEvent(QWheelEvent *event) override;
@@ -85,6 +121,7 @@ protected:
     void mouseReleaseEvent(QMouseEvent *event) override;
     void focusOutEvent(QFocusEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
 
 private:
     void createEditor();
@@ -95,12 +132,20 @@ private:
     void updateEditorOverlayPosition();
     void updateLegendOverlay();
     void updateLegend();
+    static QVector<LegendItem> sortedLegend(const QSet<QPair<QString, QColor>>& items);
     void updateCheckboxOverlayPosition();
+    void updateMinimapPosition();
+    void updateMinimapSnapshot();
+    void updateMinimapViewport();
 
     void toggleCompLabelVisibility(int state);
     void toggleCompTextVisibility(int state);
     void toggleCompPosDesignationVisibility(int state);
 
+    // Выделение нескольких цепей; редактор показывает атрибуты первой из них
+    void setSelectedNets(const QStringList& keys);
+    void selectNetsInRect(const QRect& viewRect, bool extend);
+    void updateNetComponentsLabel(const QString& key);
     void selectLine(QList<QGraphicsLineItem*>& lineGroup);
     void deselectLine(QList<QGraphicsLineItem*>& lineGroup);
 
@@ -117,19 +162,41 @@ private:
 
     void hideEditor();
     void applyChanges();
+    void pushStyleEdit(const QString& text);
 
     QStringList getCurrentDesignations(QComboBox* combo);
 
     void displayComponents(Circuit* circuit);
     void displayConnecors(Circuit* circuit);
     void displayNodes(Circuit* circuit);
+    void displayComponent(Component* comp);
+    void displayConnector(Connector* conn);
+    QGraphicsLineItem* addWire(const QLineF& line, const QPen& pen);
+    void displayNode(Node* node);
+
+    void applyLiveColors(const QHash<QString, QColor>& colors);
+    void refreshFromModel(SignalVisualizer::ChangeAspects aspects, const QSet<QString>& nets);
+
+    void startStagedBuild();
+    void processBuildSlice();
+    void finishBuild();
+    void updateProgressOverlayPosition();
+
+    void scheduleProxyMaterialization();
+    void materializeVisibleProxies();
+    void evictProxies(const QRectF& visibleRect);
+    void proxyDestroyed(QObject* proxy);
+
+    // Отрисовка области сцены с развёрнутыми прокси, в том числе вне экрана
+    void renderSceneForExport(QPainter* painter, const QRectF& target, const QRectF& source);
 
     Circuit* m_circuitInstance;
     QVector<LegendItem> m_legendItems;
+    QVector<LegendItem> m_designationLegend;
+    QVector<LegendItem> m_typeLegend;
 
     SignalVisualizerWidget* m_signalVisualizerWidget;
 
-    QVBoxLayout *m_layout;
     QVBoxLayout *m_checkboxLayout;
     QHBoxLayout *m_buttonLayout;
     QFormLayout *m_lineEditLayout;
@@ -150,8 +217,15 @@ private:
     bool m_isPanning = false;
     QPoint m_lastMousePosition;
 
+    QRubberBand* m_rubberBand;
+    QPoint m_rubberBandOrigin;
+    bool m_isRubberBanding = false;
+
     QWidget *m_lineEditOverlay;
-    QWidget *m_legendOverlay;
+    LegendWidget *m_legendOverlay;
+    MinimapWidget *m_minimap;
+    QTimer *m_minimapTimer;
+    bool m_minimapEnabled = true;
     QWidget *m_checkboxOverlay;
     QCheckBox *m_hideCompLabelCheckbox;
     QCheckBox *m_hideCompTextCheckbox;
@@ -162,11 +236,38 @@ private:
 
     QTextEdit* m_designationInfoEdit;
     QTextEdit* m_typeInfoEdit;
+    QLabel* m_netComponentsLabel;
 
     QGraphicsLineItem* m_selectedLineItem = nullptr;
-    QList<QGraphicsLineItem*> m_selectedLineGroup;
+    QStringList m_selectedNets;
+    QList<QGraphicsLineItem*> m_selectedLineGroup;  // линии всех выделенных цепей
     
     QList<ComponentOverlayTextItem*> m_overlayItems;
+
+    // Развёрнутые прокси; вытесняются первыми те, что дольше всех не попадали в окно
+    struct MaterializedProxy {
+        MainComponentProxyItem* proxy = nullptr;
+        int cost = 0;
+        quint64 lastVisible = 0;    // номер прохода materializeVisibleProxies
+    };
+    QHash<const QObject*, MaterializedProxy> m_materializedProxies;
+    quint64 m_materializePass = 0;
+    int m_proxyItemBudget = 4000;
+    int m_materializedItemCount = 0;
+    bool m_materializePending = false;
+
+    // Поэтапное построение сцены по квантам цикла событий
+    BuildStage m_buildStage = BuildStage::Done;
+    QList<QPointer<Connector>> m_pendingConnectors;
+    QList<QPointer<Component>> m_pendingComponents;
+    QList<QPointer<Node>> m_pendingNodes;
+    int m_buildIndex = 0;
+    int m_buildProgress = 0;
+    const int m_buildSliceMs = 12;
+    QTimer* m_buildTimer = nullptr;
+    QProgressBar* m_progressOverlay = nullptr;
+
+    NetSampler* m_netSampler = nullptr;
 };
 
 #endif // SIGNALVISUALIZERGRAPHICSVIEW_H
@@ -21,13 +21,35 @@
 #include "varsource.h"
 #include "battery.h"
 #include <algorithm>
+#include "netsampler.h"
+#include "colorschemebinary.h"
+#include "configautosaver.h"
+#include "schematicexporter.h"
+#include "signalvisualizerbatch.h"
+#include <QFutureWatcher>
+#include <QProgressDialog>
+#include <functional>
+#include <QUndoStack>
+#include <QFileInfo>
+#include <QActionGroup>
+#include <QLineEdit>
+#include <QCompleter>
+#include <QAbstractItemView>
+#include <QStandardItemModel>
+#include <QSplitter>
+#include "netinspector.h"
 
 
 SignalVisualizerWidget::SignalVisualizerWidget(QWidget *parent) : QWidget(parent)
 {
     m_circuitInstance = Circuit::self();
     m_visualizerModel = new SignalVisualizer(this);
-    connect(m_visualizerModel, &SignalVisualizer::sceneUpdated, this, &SignalVisualizerWidget::updateScene);
+    connect(m_visualizerModel, &SignalVisualizer::configLoaded, this, &SignalVisualizerWidget::onConfigLoaded);
+    connect(m_visualizerModel, &SignalVisualizer::configLoadFailed, this, &SignalVisualizerWidget::onConfigLoadFailed);
+    m_autosaver = new ConfigAutosaver(m_visualizerModel, this);
+    connect(m_autosaver, &ConfigAutosaver::saveFinished, this, &SignalVisualizerWidget::onConfigSaved);
+    connect(m_autosaver, &ConfigAutosaver::autosaveFailed, this, &SignalVisualizerWidget::onAutosaveFailed);
+    m_undoStack = new QUndoStack(this);
     setupUI();
     applyStyles();
 }
@@ -51,6 +73,38 @@ void SignalVisualizerWidget::setupUI() {
     });
     connect(saveAsAction, &QAction::triggered, this, &SignalVisualizerWidget::saveAsConfig);
 
+    QAction *convertAction = new QAction(tr("Преобразовать формат схемы..."), this);
+    m_fileMenu->addAction(convertAction);
+    connect(convertAction, &QAction::triggered, this, &SignalVisualizerWidget::convertConfig);
+
+    m_batchAction = new QAction(tr("Пакетная классификация схем..."), this);
+    m_fileMenu->addAction(m_batchAction);
+    connect(m_batchAction, &QAction::triggered, this, &SignalVisualizerWidget::classifyCircuits);
+
+    QAction *compressAction = new QAction(tr("Сжимать сохраняемые схемы"), this);
+    compressAction->setCheckable(true);
+    compressAction->setChecked(m_autosaver->compression());
+    m_fileMenu->addAction(compressAction);
+    connect(compressAction, &QAction::toggled, m_autosaver, &ConfigAutosaver::setCompression);
+
+    QAction *exportAction = new QAction(tr("Экспорт изображения..."), this);
+    m_fileMenu->addAction(exportAction);
+    connect(exportAction, &QAction::triggered, this, &SignalVisualizerWidget::exportImage);
+
+    m_fileMenu->addSeparator();
+    m_vcdCaptureAction = new QAction(tr("Запись сигналов в VCD..."), this);
+    m_vcdCaptureAction->setCheckable(true);
+    m_fileMenu->addAction(m_vcdCaptureAction);
+    connect(m_vcdCaptureAction, &QAction::toggled, this, &SignalVisualizerWidget::toggleVcdCapture);
+
+    m_editMenu = m_menuBar->addMenu(tr("Правка"));
+    QAction *undoAction = m_undoStack->createUndoAction(this, tr("Отменить"));
+    undoAction->setShortcut(QKeySequence::Undo);
+    QAction *redoAction = m_undoStack->createRedoAction(this, tr("Повторить"));
+    redoAction->setShortcut(QKeySequence::Redo);
+    m_editMenu->addAction(undoAction);
+    m_editMenu->addAction(redoAction);
+
     m_layout->setMenuBar(m_menuBar);
     setWindowFlags(Qt::Window);
 
@@ -72,6 +126,76 @@ void SignalVisualizerWidget::setupUI() {
     });
     m_viewMenu->addAction(toggleViewAction);
 
+    QAction *minimapAction = new QAction(tr("Миникарта"), this);
+    minimapAction->setCheckable(true);
+    minimapAction->setChecked(m_graphicsView->isMinimapVisible());
+    connect(minimapAction, &QAction::toggled, m_graphicsView, &SignalVisualizerView::setMinimapVisible);
+    m_viewMenu->addAction(minimapAction);
+
+    // Таблица цепей - боковая панель, скрытая по умолчанию
+    m_netInspector = new NetInspector(m_visualizerModel, this);
+    m_netInspector->hide();
+    connect(m_netInspector, &NetInspector::netsSelected, this, [this](const QStringList& keys) {
+        m_graphicsView->setSelectedNets(keys);
+    });
+    connect(m_netInspector, &NetInspector::netActivated, m_graphicsView, &SignalVisualizerView::focusNet);
+
+    m_splitter = new QSplitter(Qt::Horizontal, this);
+    m_splitter->addWidget(m_graphicsView);
+    m_splitter->addWidget(m_netInspector);
+    m_splitter->setStretchFactor(0, 3);
+    m_splitter->setStretchFactor(1, 1);
+    m_splitter->setChildrenCollapsible(false);
+
+    QAction *inspectorAction = new QAction(tr("Таблица цепей"), this);
+    inspectorAction->setCheckable(true);
+    connect(inspectorAction, &QAction::toggled, m_netInspector, &QWidget::setVisible);
+    m_viewMenu->addAction(inspectorAction);
+
+    m_viewMenu->addSeparator();
+    QAction *liveModeAction = new QAction(tr("Состояние симуляции в реальном времени"), this);
+    liveModeAction->setCheckable(true);
+    connect(liveModeAction, &QAction::toggled, m_graphicsView, &SignalVisualizerView::setLiveMode);
+    m_viewMenu->addAction(liveModeAction);
+
+    QActionGroup *liveModeGroup = new QActionGroup(this);
+    const QList<QPair<QString, NetSampler::Mode>> liveModes = {
+        {tr("Напряжение цепей"), NetSampler::Mode::Voltage},
+        {tr("Логические уровни"), NetSampler::Mode::Logic},
+        {tr("Тепловая карта переключений"), NetSampler::Mode::Heatmap}
+    };
+    for (const auto& liveMode : liveModes) {
+        QAction *modeAction = liveModeGroup->addAction(liveMode.first);
+        modeAction->setCheckable(true);
+        modeAction->setChecked(liveMode.second == NetSampler::Mode::Logic);
+        NetSampler::Mode mode = liveMode.second;
+        connect(modeAction, &QAction::triggered, this, [this, mode]() {
+            m_graphicsView->setLiveSamplingMode(static_cast<int>(mode));
+        });
+        m_viewMenu->addAction(modeAction);
+    }
+
+    // Поиск цепи: результаты пересчитываются по индексу модели на каждое нажатие
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setPlaceholderText(tr("Поиск цепи..."));
+    m_searchEdit->setClearButtonEnabled(true);
+    m_searchEdit->setMinimumWidth(220);
+    m_searchResults = new QStandardItemModel(this);
+    m_searchCompleter = new QCompleter(m_searchResults, this);
+    m_searchCompleter->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    m_searchCompleter->setMaxVisibleItems(15);
+    m_searchCompleter->setWidget(m_searchEdit);
+    m_menuBar->setCornerWidget(m_searchEdit, Qt::TopRightCorner);
+    connect(m_searchEdit, &QLineEdit::textEdited, this, &SignalVisualizerWidget::updateSearchResults);
+    connect(m_searchCompleter, QOverload<const QModelIndex&>::of(&QCompleter::activated), this, [this](const QModelIndex& index) {
+        m_graphicsView->focusNet(index.data(Qt::UserRole).toString());
+    });
+    connect(m_searchEdit, &QLineEdit::returnPressed, this, [this]() {
+        if (m_searchResults->rowCount() > 0) {
+            m_graphicsView->focusNet(m_searchResults->item(0)->data(Qt::UserRole).toString());
+        }
+    });
+
     m_helpMenu = m_menuBar->addMenu(tr("Помощь"));
     QAction *helpAction = new QAction(tr("Справка"), this);
     m_helpMenu->addAction(helpAction);
@@ -81,13 +205,28 @@ void SignalVisualizerWidget::setupUI() {
     connect(m_closeButton, &QPushButton::clicked, this, &SignalVisualizerWidget::closeVisualizer);
 
     m_layout->addWidget(m_label);
-    m_layout->addWidget(m_graphicsView);
+    m_layout->addWidget(m_splitter);
     m_layout->addWidget(m_closeButton);
 
     setWindowTitle("Visualizer");
     setMinimumSize(600, 400);
 }
 
+void SignalVisualizerWidget::updateSearchResults(const QString& text) {
+    const QVector<NetSearchIndex::Match> matches = m_visualizerModel->searchIndex().search(text, 50);
+
+    m_searchResults->clear();
+    for (const NetSearchIndex::Match& match : matches) {
+        QStandardItem* item = new QStandardItem(match.term);
+        item->setData(match.key, Qt::UserRole);
+        item->setToolTip(match.key);
+        m_searchResults->appendRow(item);
+    }
+
+    if (matches.isEmpty()) m_searchCompleter->popup()->hide();
+    else m_searchCompleter->complete();
+}
+
 void SignalVisualizerWidget::applyStyles() {
     m_label->setStyleSheet("font-size: 16px; font-weight: bold; color: #333;");
     m_closeButton->setStyleSheet(R"(
@@ -108,13 +247,25 @@ void SignalVisualizerWidget::closeVisualizer() {
     this->close();
 }
 
+void SignalVisualizerWidget::closeEvent(QCloseEvent *event) {
+    // Прерываем незавершённое построение сцены и фоновую классификацию
+    m_graphicsView->cancelBuild();
+    if (m_visualizerModel->isLoadingConfig()) {
+        m_visualizerModel->cancelConfigLoad();
+        QApplication::restoreOverrideCursor();
+    }
+    m_vcdCaptureAction->setChecked(false);
+    m_autosaver->flush();
+    QWidget::closeEvent(event);
+}
+
 void SignalVisualizerWidget::saveConfig() {
 if (m_currentFileName.isEmpty()) {
     QString fileName = QFileDialog::getSaveFileName(
         this,
         tr("Сохранить файл"),
         "",
-        tr("ColorScheme Files (*.cscfg)"),
+        tr("ColorScheme Files (*.cscfg);;Binary ColorScheme Files (*.cscb)"),
         nullptr,
         QFileDialog::DontUseNativeDialog
     );
@@ -128,31 +279,36 @@ if (m_currentFileName.isEmpty()) {
 }
 
 void SignalVisualizerWidget::saveConfig(QString &fileName) {
-    QApplication::setOverrideCursor(Qt::WaitCursor);
+    if( !fileName.endsWith(".cscfg") && !fileName.endsWith(".cscb") ) fileName.append(".cscfg");
 
-    if( !fileName.endsWith(".cscfg") ) fileName.append(".cscfg");
-    QString config;
-    if(m_visualizerModel) {
-        config = m_visualizerModel -> toString();
-    }
-    QFile file( fileName );
-    if (!file.open(QFile::WriteOnly | QFile::Text)) {
-        QApplication::restoreOverrideCursor();
+    // Сети пишутся в файл по одной, без копии всей схемы
+    m_autosaver->save(fileName);
+}
+
+void SignalVisualizerWidget::onConfigSaved(const QString &fileName, const QString &error) {
+    if (!error.isEmpty()) {
         QMessageBox::warning(this, "Ошибка сохранения",
                     tr("Не удалось записать файл %1:\n%2.")
                          .arg(fileName)
-                         .arg(file.errorString()));
+                         .arg(error));
         return;
     }
 
-    QTextStream out(&file);
-    out.setCodec("UTF-8");
-    out << config;
-    file.close();
-
-    QApplication::restoreOverrideCursor();
     QMessageBox::information(this, "Сохранение успешно", "Файл успешно сохранён!");
     m_currentFileName = fileName;
+    m_autosaveErrorShown = false;
+}
+
+void SignalVisualizerWidget::onAutosaveFailed(const QString &error) {
+    qWarning() << "SignalVisualizer autosave:" << error;
+
+    // Автосохранение повторяется при каждой правке, поэтому окно показывается один раз
+    // до следующего удачного сохранения или загрузки
+    if (m_autosaveErrorShown) return;
+    m_autosaveErrorShown = true;
+    QMessageBox::warning(this, tr("Ошибка автосохранения"),
+        tr("Не удалось автоматически сохранить изменения:\n%1\n"
+           "Сохраните конфигурацию вручную, чтобы не потерять правки.").arg(error));
 }
 
 void SignalVisualizerWidget::saveAsConfig() {
@@ -160,7 +316,7 @@ void SignalVisualizerWidget::saveAsConfig() {
         this,
         tr("Сохранить как..."),
         "",
-        tr("ColorScheme Files (*.cscfg)"),
+        tr("ColorScheme Files (*.cscfg);;Binary ColorScheme Files (*.cscb)"),
         nullptr,
         QFileDialog::DontUseNativeDialog
     );
@@ -175,7 +331,7 @@ void SignalVisualizerWidget::loadConfig() {
         this,
         tr("Загрузить файл конфигурации"),
         "",
-        tr("ColorScheme Files (*.cscfg);;Все файлы (*)"),
+        tr("ColorScheme Files (*.cscfg *.cscb);;Все файлы (*)"),
         nullptr,
         QFileDialog::DontUseNativeDialog
     );
@@ -186,30 +342,215 @@ void SignalVisualizerWidget::loadConfig() {
 }
 
 void SignalVisualizerWidget::loadConfig(const QString &fileName) {
+    // Файл читается в фоне, атрибуты применяются одним пакетом по готовности
+    if (!m_visualizerModel->isLoadingConfig()) {
+        QApplication::setOverrideCursor(Qt::BusyCursor);
+    }
+    m_visualizerModel->loadConfigAsync(fileName);
+}
+
+void SignalVisualizerWidget::onConfigLoaded(const QString &fileName) {
+    QApplication::restoreOverrideCursor();
+
+    // Загрузка заменяет оформление всех цепей, прежние правки отменить уже нельзя
+    m_undoStack->clear();
+
+    // Изменения, не попавшие в файл до закрытия редактора, восстанавливаются из журнала
+    int recovered = m_autosaver->setFileName(fileName);
+    if (recovered > 0) {
+        QMessageBox::information(this, tr("Загрузка завершена"),
+            tr("Конфигурация загружена из\n%1\nВосстановлено несохранённых изменений: %2").arg(fileName).arg(recovered));
+    } else {
+        QMessageBox::information(this, tr("Загрузка завершена"),
+            tr("Конфигурация успешно загружена из\n%1").arg(fileName));
+    }
+
+    m_currentFileName = fileName;
+    m_autosaveErrorShown = false;
+    m_graphicsView->clearSelection();
+    m_graphicsView->hideEditor();
+}
+
+void SignalVisualizerWidget::onConfigLoadFailed(const QString &fileName, const QString &error) {
+    QApplication::restoreOverrideCursor();
+    QMessageBox::warning(this, tr("Ошибка загрузки"),
+        tr("Не удалось загрузить файл %1:\n%2").arg(fileName).arg(error));
+}
+
+void SignalVisualizerWidget::convertConfig() {
+    QString inputFile = QFileDialog::getOpenFileName(
+        this,
+        tr("Исходный файл схемы"),
+        "",
+        tr("ColorScheme Files (*.cscfg *.cscb);;Все файлы (*)"),
+        nullptr,
+        QFileDialog::DontUseNativeDialog
+    );
+    if (inputFile.isEmpty()) return;
+
+    // XML преобразуется в двоичный формат и наоборот
+    QFile input(inputFile);
+    const bool toBinary = input.open(QIODevice::ReadOnly) && !ColorSchemeBinary::isBinaryFile(&input);
+    input.close();
+
+    QString outputFile = QFileDialog::getSaveFileName(
+        this,
+        tr("Сохранить преобразованный файл"),
+        QFileInfo(inputFile).completeBaseName() + (toBinary ? ".cscb" : ".cscfg"),
+        toBinary ? tr("Binary ColorScheme Files (*.cscb)") : tr("ColorScheme Files (*.cscfg)"),
+        nullptr,
+        QFileDialog::DontUseNativeDialog
+    );
+    if (outputFile.isEmpty()) return;
+
     QApplication::setOverrideCursor(Qt::WaitCursor);
+    QString error;
+    bool converted = ColorSchemeBinary::convert(inputFile, outputFile, &error);
+    QApplication::restoreOverrideCursor();
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QApplication::restoreOverrideCursor();
-        QMessageBox::warning(this, tr("Ошибка загрузки"),
-            tr("Не удалось открыть файл %1:\n%2.")
-                .arg(fileName)
-                .arg(file.errorString()));
+    if (!converted) {
+        QMessageBox::warning(this, tr("Ошибка преобразования"),
+            tr("Не удалось преобразовать файл %1:\n%2.")
+                .arg(inputFile)
+                .arg(error));
         return;
     }
+    QMessageBox::information(this, tr("Преобразование завершено"),
+        tr("Файл сохранён как\n%1").arg(outputFile));
+}
+
+void SignalVisualizerWidget::classifyCircuits() {
+    QStringList files = QFileDialog::getOpenFileNames(
+        this,
+        tr("Схемы для классификации"),
+        "",
+        tr("SimulIDE Circuits (*.sim1 *.simu);;Все файлы (*)"),
+        nullptr,
+        QFileDialog::DontUseNativeDialog
+    );
+    if (files.isEmpty()) return;
+
+    // Отчёты пишутся рядом со схемами, как при запуске с --classify; прежние заменяются только с согласия
+    SignalVisualizerBatch::Options options;
+    QStringList existing;
+    for (const QString& file : files) {
+        const QString output = SignalVisualizerBatch::outputFileName(file, options);
+        if (QFileInfo::exists(output)) existing.append(QFileInfo(output).fileName());
+    }
+    if (!existing.isEmpty()) {
+        const QMessageBox::StandardButton answer = QMessageBox::question(this, tr("Замена отчётов"),
+            tr("Уже существуют отчёты: %1\n%2\nЗаменить их?")
+                .arg(existing.size())
+                .arg(existing.mid(0, 10).join("\n")));
+        if (answer != QMessageBox::Yes) return;
+        options.overwrite = true;
+    }
 
-    QTextStream in(&file);
-    QString xmlContent = in.readAll();
-    file.close();
+    // Схемы обрабатываются в пуле потоков, окно остаётся отзывчивым
+    auto* watcher = new QFutureWatcher<SignalVisualizerBatch::Result>(this);
+    auto* progress = new QProgressDialog(tr("Классификация схем..."), tr("Отмена"), 0, files.size(), this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+    progress->setAutoClose(false);
+    progress->setAutoReset(false);
+
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(progress, &QProgressDialog::canceled, watcher, &QFutureWatcherBase::cancel);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, progress]() {
+        progress->close();
+        progress->deleteLater();
+        watcher->deleteLater();
+        m_batchAction->setEnabled(true);
+
+        QStringList failures;
+        const QList<SignalVisualizerBatch::Result> results = watcher->future().results();
+        for (const SignalVisualizerBatch::Result& result : results) {
+            if (!result.error.isEmpty()) failures.append(result.circuitFile + ": " + result.error);
+        }
+        onCircuitsClassified(results.size() - failures.size(), failures, watcher->isCanceled());
+    });
+
+    m_batchAction->setEnabled(false);
+    std::function<SignalVisualizerBatch::Result(const QString&)> classify = [options](const QString& file) {
+        return SignalVisualizerBatch::classifyFile(file, options);
+    };
+    watcher->setFuture(QtConcurrent::mapped(files, classify));
+}
+
+void SignalVisualizerWidget::onCircuitsClassified(int classified, const QStringList& failures, bool canceled) {
+    const QString summary = canceled
+        ? tr("Классификация прервана. Обработано схем: %1").arg(classified)
+        : tr("Обработано схем: %1 из %2").arg(classified).arg(classified + failures.size());
+    if (!failures.isEmpty()) {
+        QMessageBox::warning(this, tr("Ошибка классификации"), summary + "\n" + failures.join("\n"));
+        return;
+    }
+    QMessageBox::information(this, tr("Классификация завершена"), summary);
+}
+
+void SignalVisualizerWidget::exportImage() {
+    QString selectedFilter;
+    QString fileName = QFileDialog::getSaveFileName(
+        this,
+        tr("Экспорт изображения"),
+        m_currentFileName.isEmpty() ? QString() : QFileInfo(m_currentFileName).completeBaseName() + ".png",
+        tr("PNG (*.png);;SVG (*.svg);;PDF (*.pdf)"),
+        &selectedFilter,
+        QFileDialog::DontUseNativeDialog
+    );
+    if (fileName.isEmpty()) return;
+
+    if (QFileInfo(fileName).suffix().isEmpty()) {
+        if (selectedFilter.contains("*.svg")) fileName.append(".svg");
+        else if (selectedFilter.contains("*.pdf")) fileName.append(".pdf");
+        else fileName.append(".png");
+    }
 
-    m_visualizerModel->loadFromString(xmlContent);
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QString error;
+    bool exported = SchematicExporter::exportToFile(m_graphicsView, fileName, SchematicExporter::Options(), &error);
     QApplication::restoreOverrideCursor();
-    QMessageBox::information(this, tr("Загрузка завершена"),
-        tr("Конфигурация успешно загружена из\n%1").arg(fileName));
 
-    m_currentFileName = fileName;
-    m_graphicsView->clearSelection();
-    m_graphicsView->hideEditor();
+    if (!exported) {
+        QMessageBox::warning(this, tr("Ошибка экспорта"),
+            tr("Не удалось экспортировать изображение %1:\n%2.")
+                .arg(fileName)
+                .arg(error));
+    }
+}
+
+void SignalVisualizerWidget::toggleVcdCapture(bool enabled) {
+    if (!enabled) {
+        QString error;
+        if (!m_graphicsView->stopVcdCapture(&error)) {
+            QMessageBox::warning(this, tr("Ошибка записи"),
+                tr("Запись сигналов прервана, файл неполон:\n%1.").arg(error));
+        }
+        return;
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(
+        this,
+        tr("Запись сигналов"),
+        "",
+        tr("Value Change Dump (*.vcd)"),
+        nullptr,
+        QFileDialog::DontUseNativeDialog
+    );
+
+    QString error;
+    if (!fileName.isEmpty()) {
+        if (!fileName.endsWith(".vcd")) fileName.append(".vcd");
+        if (m_graphicsView->startVcdCapture(fileName, &error)) return;
+
+        QMessageBox::warning(this, tr("Ошибка записи"),
+            tr("Не удалось записать файл %1:\n%2.")
+                .arg(fileName)
+                .arg(error));
+    }
+
+    QSignalBlocker blocker(m_vcdCaptureAction);
+    m_vcdCaptureAction->setChecked(false);
 }
 
 void SignalVisualizerWidget::showHelp() {
@@ -226,10 +567,6 @@ void SignalVisualizerWidget::showHelp() {
     );
 }
 
-void SignalVisualizerWidget::updateScene() {
-    m_scene -> update();
-}
-
 SignalVisualizerWidget::~SignalVisualizerWidget(){
     delete m_scene;
 }
@@ -12,11 +12,20 @@
 #include <QDataStream>
 #include <QFile>
 #include <QXmlStreamReader>
+#include <QCloseEvent>
 #include "signalvisualizer.h"
 #include "signalvisualizerview.h"
 #include "circuit.h"
 
 class SignalVisualizer;
+class SignalVisualizerView;
+class ConfigAutosaver;
+class QUndoStack;
+class QLineEdit;
+class QCompleter;
+class QStandardItemModel;
+class QSplitter;
+class NetInspector;
 
 class SignalVisualizerWidget : public QWidget
 {
@@ -30,8 +39,8 @@ public:
     explicit SignalVisualizerWidget(QWidget *parent = nullptr);
     ~SignalVisualizerWidget();
 
-public slots:
-    void updateScene();
+protected:
+    void closeEvent(QCloseEvent *event) override;
 
 private:
     void setupUI();
@@ -43,15 +52,28 @@ private:
     void saveAsConfig();
     void loadConfig(const QString &fileName);
     void loadConfig();
+    void convertConfig();
+    void classifyCircuits();
+    void onCircuitsClassified(int classified, const QStringList& failures, bool canceled);
+    void exportImage();
+    void onConfigLoaded(const QString &fileName);
+    void onConfigLoadFailed(const QString &fileName, const QString &error);
+    void onConfigSaved(const QString &fileName, const QString &error);
+    void onAutosaveFailed(const QString &error);
+    void toggleVcdCapture(bool enabled);
+    void updateSearchResults(const QString& text);
     void showHelp();
 
     Circuit* getCircuit() const {return m_circuitInstance;};
     SignalVisualizer* getModel() const { return m_visualizerModel; }
     SignalVisualizerView* getView() const { return m_graphicsView; }
+    QUndoStack* getUndoStack() const { return m_undoStack; }
 
     Circuit* m_circuitInstance;
     SignalVisualizerView* m_graphicsView;
     SignalVisualizer* m_visualizerModel;
+    ConfigAutosaver* m_autosaver;
+    QUndoStack* m_undoStack;
 
     QVBoxLayout* m_layout;
 
@@ -62,10 +84,21 @@ private:
     QMenu* m_fileMenu;
     QMenuBar* m_menuBar;
     QMenu* m_viewMenu;
+    QMenu* m_editMenu;
     QMenu* m_helpMenu;
+    QAction* m_vcdCaptureAction;
+    QAction* m_batchAction;
+
+    QLineEdit* m_searchEdit;
+    QCompleter* m_searchCompleter;
+    QStandardItemModel* m_searchResults;
+
+    QSplitter* m_splitter;
+    NetInspector* m_netInspector;
 
     QString m_currentFileName;
     QString m_lastFileName;
+    bool m_autosaveErrorShown = false;
 };
 
 #endif // SIGNALVISUALIZERWIDGET_H
@@ -0,0 +1,35 @@
+#include <cstring>
+#include "stablehash.h"
+
+namespace {
+    constexpr quint64 FnvOffset = 0xcbf29ce484222325ull;
+    constexpr quint64 FnvPrime = 0x100000001b3ull;
+}
+
+quint64 StableHash::string(const QString& value) {
+    quint64 h = FnvOffset;
+    const ushort* units = value.utf16();
+    for (int i = 0; i < value.size(); ++i) {
+        h = (h ^ (units[i] & 0xff)) * FnvPrime;
+        h = (h ^ (units[i] >> 8)) * FnvPrime;
+    }
+    return h;
+}
+
+quint64 StableHash::number(double value) {
+    // -0.0 и 0.0 дают один хеш
+    if (value == 0.0) value = 0.0;
+
+    quint64 bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return mix(bits);
+}
+
+quint64 StableHash::mix(quint64 h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h;
+}
@@ -0,0 +1,18 @@
+#ifndef STABLEHASH_H
+#define STABLEHASH_H
+
+#include <QString>
+
+// Хеши для данных, сохраняемых на диск (.cscb, .sigcache).
+// В отличие от qHash, результат задан алгоритмом и не зависит от сборки Qt, процессора и порядка байт.
+class StableHash {
+public:
+    // FNV-1a над кодовыми единицами UTF-16, каждая единица - младший байт, затем старший
+    static quint64 string(const QString& value);
+    static quint64 number(double value);
+
+    // Финальное перемешивание splitmix64
+    static quint64 mix(quint64 h);
+};
+
+#endif // STABLEHASH_H
@@ -0,0 +1,136 @@
+#include <QDateTime>
+#include <QRegularExpression>
+#include <QSet>
+#include <QtConcurrent>
+#include "vcdwriter.h"
+
+VcdWriter::VcdWriter(int bufferCapacity)
+    : m_capacity(size_t(qMax(1, bufferCapacity))) {
+    m_front.reserve(m_capacity);
+    m_back.reserve(m_capacity);
+}
+
+VcdWriter::~VcdWriter() {
+    close();
+}
+
+bool VcdWriter::open(const QString& fileName, const QStringList& signalNames) {
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    m_identifiers.clear();
+    m_lastTime = 0;
+    m_error.clear();
+
+    QByteArray header;
+    header += "$date " + QDateTime::currentDateTime().toString(Qt::ISODate).toUtf8() + " $end\n";
+    header += "$version SimulIDE SignalVisualizer $end\n";
+    header += "$timescale 1ps $end\n";
+    header += "$scope module circuit $end\n";
+
+    QSet<QString> usedNames;
+    for (int i = 0; i < signalNames.size(); ++i) {
+        QByteArray id = identifier(i);
+        QString name = sanitizeName(signalNames[i]);
+
+        // Одинаковые обозначения у разных цепей различаем суффиксом
+        QString uniqueName = name;
+        for (int n = 2; usedNames.contains(uniqueName); ++n) {
+            uniqueName = name + "_" + QString::number(n);
+        }
+        usedNames.insert(uniqueName);
+
+        m_identifiers.append(id);
+        header += "$var wire 1 " + id + " " + uniqueName.toUtf8() + " $end\n";
+    }
+
+    header += "$upscope $end\n";
+    header += "$enddefinitions $end\n";
+    header += "#0\n$dumpvars\n";
+    for (const QByteArray& id : m_identifiers) {
+        header += "x" + id + "\n";
+    }
+    header += "$end\n";
+
+    if (m_file.write(header) != header.size()) {
+        m_error = m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+bool VcdWriter::close() {
+    if (!m_file.isOpen()) return m_error.isEmpty();
+
+    swapBuffers();
+    m_flush.waitForFinished();
+    m_file.close();
+    if (m_error.isEmpty() && m_file.error() != QFileDevice::NoError) {
+        m_error = m_file.errorString();
+    }
+    return m_error.isEmpty();
+}
+
+void VcdWriter::record(quint64 timePs, int signal, char value) {
+    if (signal < 0 || signal >= m_identifiers.size()) return;
+
+    m_front.push_back({timePs, signal, value});
+    if (m_front.size() >= m_capacity) {
+        swapBuffers();
+    }
+}
+
+void VcdWriter::swapBuffers() {
+    // Второй буфер освобождается только после окончания предыдущей записи
+    m_flush.waitForFinished();
+    if (m_front.empty()) return;
+
+    std::swap(m_front, m_back);
+    m_front.clear();
+    m_flush = QtConcurrent::run([this]() { writeSamples(m_back); });
+}
+
+void VcdWriter::writeSamples(const std::vector<Sample>& samples) {
+    // После первой ошибки файл уже неполон, дальнейшие отсчёты не пишутся
+    if (!m_error.isEmpty()) return;
+
+    QByteArray chunk;
+    chunk.reserve(int(samples.size()) * 16);
+
+    for (const Sample& sample : samples) {
+        // После перезапуска симуляции время начинается заново, VCD требует неубывающих меток
+        quint64 time = qMax(sample.time, m_lastTime);
+        if (time != m_lastTime) {
+            chunk += '#' + QByteArray::number(time) + '\n';
+            m_lastTime = time;
+        }
+        chunk += sample.value;
+        chunk += m_identifiers[sample.signal];
+        chunk += '\n';
+    }
+    if (m_file.write(chunk) != chunk.size()) {
+        m_error = m_file.errorString();
+    }
+}
+
+QByteArray VcdWriter::identifier(int index) {
+    // Идентификаторы VCD составляются из печатных символов ASCII 33..126
+    QByteArray id;
+    do {
+        id.append(char(33 + index % 94));
+        index = index / 94 - 1;
+    } while (index >= 0);
+    return id;
+}
+
+QString VcdWriter::sanitizeName(const QString& name) {
+    QString result = name.trimmed();
+    result.replace(QRegularExpression("[^A-Za-z0-9_\\[\\]\\.]"), "_");
+    if (result.isEmpty()) result = "net";
+    return result;
+}
@@ -0,0 +1,50 @@
+#ifndef VCDWRITER_H
+#define VCDWRITER_H
+
+#include <QString>
+#include <QStringList>
+#include <QFile>
+#include <QFuture>
+#include <vector>
+
+// Потоковая запись изменений логических уровней цепей в формате Value Change Dump.
+// Переключения приходят из потока симуляции в момент изменения напряжения узла и помечаются
+// временем схемы, поэтому разрешение записи равно шагу симуляции, а не частоте опроса.
+// Отсчёты копятся в одном из двух буферов, заполненный буфер сбрасывается в файл фоновым потоком.
+class VcdWriter {
+public:
+    explicit VcdWriter(int bufferCapacity = 65536);
+    ~VcdWriter();
+
+    bool open(const QString& fileName, const QStringList& signalNames);
+    // false, если хотя бы одна запись не удалась: файл тогда обрезан
+    bool close();
+    bool isOpen() const { return m_file.isOpen(); }
+    QString errorString() const { return m_error.isEmpty() ? m_file.errorString() : m_error; }
+
+    // Вызывается из потока симуляции; timePs - время схемы в пикосекундах
+    void record(quint64 timePs, int signal, char value);
+
+private:
+    struct Sample {
+        quint64 time;
+        int signal;
+        char value;
+    };
+
+    static QByteArray identifier(int index);
+    static QString sanitizeName(const QString& name);
+    void swapBuffers();
+    void writeSamples(const std::vector<Sample>& samples);
+
+    QFile m_file;
+    QList<QByteArray> m_identifiers;
+    std::vector<Sample> m_front;
+    std::vector<Sample> m_back;
+    QFuture<void> m_flush;
+    size_t m_capacity;
+    quint64 m_lastTime = 0;
+    QString m_error;    // первая ошибка записи; поток сброса пишет, GUI-поток читает после ожидания m_flush
+};
+
+#endif // VCDWRITER_H
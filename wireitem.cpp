@@ -0,0 +1,159 @@
+#include <QPainter>
+#include "wireitem.h"
+
+void NetPalette::clear() {
+    m_designationColors.clear();
+    m_typeColors.clear();
+}
+
+int NetPalette::addSlot(const QColor& designationColor, const QColor& typeColor) {
+    m_designationColors.append(designationColor);
+    m_typeColors.append(typeColor);
+    return m_designationColors.size() - 1;
+}
+
+void NetPalette::setDesignationColor(int slot, const QColor& color) {
+    if (hasSlot(slot)) m_designationColors[slot] = color;
+}
+
+void NetPalette::setTypeColor(int slot, const QColor& color) {
+    if (hasSlot(slot)) m_typeColors[slot] = color;
+}
+
+QColor NetPalette::color(int slot) const {
+    const QColor& color = m_showTypes ? m_typeColors[slot] : m_designationColors[slot];
+    return color.isValid() ? color : QColor(Qt::gray);
+}
+
+WireItem::WireItem(const QLineF& line, const QPen& pen, const NetPalette* palette)
+    : QGraphicsLineItem(line), m_palette(palette) {
+    setPen(pen);
+}
+
+void WireItem::setOverrideColor(const QColor& color) {
+    if (m_overrideColor == color) return;
+    m_overrideColor = color;
+    update();
+}
+
+void WireItem::clearOverrideColor() {
+    if (!m_overrideColor.isValid()) return;
+    m_overrideColor = QColor();
+    update();
+}
+
+QColor WireItem::color() const {
+    if (m_overrideColor.isValid()) return m_overrideColor;
+    // До классификации провод ещё не привязан к сети и рисуется исходным пером
+    if (m_palette && m_palette->hasSlot(m_slot)) return m_palette->color(m_slot);
+    return pen().color();
+}
+
+void WireItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*, QWidget*) {
+    QPen pen = this->pen();
+    pen.setColor(color());
+    painter->setPen(pen);
+    painter->drawLine(line());
+}
+
+void WireItem::validateGeometry() const {
+    // setLine и setPen не виртуальные, поэтому кэш сверяется с текущими линией и шириной
+    const QLineF current = line();
+    const qreal width = pen().widthF();
+    if (current == m_cachedLine && width == m_cachedWidth) return;
+
+    m_cachedLine = current;
+    m_cachedWidth = width;
+    const qreal r = radius();
+    m_boundingRect = QRectF(current.p1(), current.p2()).normalized().adjusted(-r, -r, r, r);
+    m_shapeValid = false;
+}
+
+qreal WireItem::radius() const {
+    return qMax<qreal>(m_cachedWidth, 1.0) / 2;
+}
+
+QRectF WireItem::boundingRect() const {
+    validateGeometry();
+    return m_boundingRect;
+}
+
+QPainterPath WireItem::shape() const {
+    validateGeometry();
+    if (!m_shapeValid) {
+        QPainterPath path;
+        path.moveTo(m_cachedLine.p1());
+        path.lineTo(m_cachedLine.p2());
+
+        QPainterPathStroker stroker(pen());
+        stroker.setWidth(2 * radius());
+        m_shape = stroker.createStroke(path);
+        m_shapeValid = true;
+    }
+    return m_shape;
+}
+
+bool WireItem::contains(const QPointF& point) const {
+    validateGeometry();
+    if (pen().capStyle() != Qt::RoundCap) return QGraphicsLineItem::contains(point);
+    return distanceToSegment(point, m_cachedLine) <= radius();
+}
+
+bool WireItem::collidesWithPath(const QPainterPath& path, Qt::ItemSelectionMode mode) const {
+    validateGeometry();
+
+    // Сцена передаёт область выбора как прямоугольник в координатах элемента;
+    // отрезок с круглыми концами - капсула, для неё пересечение считается напрямую
+    const QRectF rect = path.boundingRect();
+    if (!isRectPath(path, rect) || pen().capStyle() != Qt::RoundCap) {
+        return QGraphicsLineItem::collidesWithPath(path, mode);
+    }
+
+    switch (mode) {
+    case Qt::ContainsItemShape:
+    case Qt::ContainsItemBoundingRect:
+        return rect.contains(m_boundingRect);
+    case Qt::IntersectsItemBoundingRect:
+        return rect.intersects(m_boundingRect);
+    case Qt::IntersectsItemShape:
+    default:
+        return rect.intersects(m_boundingRect) && intersectsRect(rect);
+    }
+}
+
+bool WireItem::isRectPath(const QPainterPath& path, const QRectF& rect) {
+    // Контур QPainterPath::addRect: пять вершин по углам, обход от левого верхнего
+    if (path.elementCount() != 5) return false;
+
+    const QPointF corners[5] = {rect.topLeft(), rect.topRight(), rect.bottomRight(), rect.bottomLeft(), rect.topLeft()};
+    for (int i = 0; i < 5; ++i) {
+        const QPainterPath::Element& element = path.elementAt(i);
+        if (element.isCurveTo() || QPointF(element.x, element.y) != corners[i]) return false;
+    }
+    return true;
+}
+
+bool WireItem::intersectsRect(const QRectF& rect) const {
+    if (rect.contains(m_cachedLine.p1()) || rect.contains(m_cachedLine.p2())) return true;
+
+    // Капсула пересекает прямоугольник, если отрезок ближе радиуса к его границе
+    const QPointF corners[4] = {rect.topLeft(), rect.topRight(), rect.bottomRight(), rect.bottomLeft()};
+    const qreal r = radius();
+    for (int i = 0; i < 4; ++i) {
+        const QLineF edge(corners[i], corners[(i + 1) % 4]);
+        if (m_cachedLine.intersects(edge, nullptr) == QLineF::BoundedIntersection) return true;
+        if (distanceToSegment(corners[i], m_cachedLine) <= r) return true;
+        if (distanceToSegment(m_cachedLine.p1(), edge) <= r || distanceToSegment(m_cachedLine.p2(), edge) <= r) return true;
+    }
+    return false;
+}
+
+qreal WireItem::distanceToSegment(const QPointF& point, const QLineF& segment) {
+    const QPointF d = segment.p2() - segment.p1();
+    const qreal lengthSquared = QPointF::dotProduct(d, d);
+    qreal t = lengthSquared > 0 ? QPointF::dotProduct(point - segment.p1(), d) / lengthSquared : 0;
+    t = qBound<qreal>(0, t, 1);
+
+    const QPointF closest = segment.p1() + t * d;
+    return QLineF(point, closest).length();
+}
@@ -0,0 +1,71 @@
+#ifndef WIREITEM_H
+#define WIREITEM_H
+
+#include <QColor>
+#include <QGraphicsLineItem>
+#include <QPainterPath>
+#include <QVector>
+
+// Цвета сетей для двух режимов отображения: по обозначениям и по типам.
+// Каждая сеть занимает одну ячейку, провода хранят только её номер.
+class NetPalette {
+public:
+    void clear();
+    int addSlot(const QColor& designationColor, const QColor& typeColor);
+    void setDesignationColor(int slot, const QColor& color);
+    void setTypeColor(int slot, const QColor& color);
+
+    void setShowTypes(bool showTypes) { m_showTypes = showTypes; }
+    bool showTypes() const { return m_showTypes; }
+
+    // Цвет ячейки в активном режиме; сети без цвета рисуются серым
+    QColor color(int slot) const;
+    bool hasSlot(int slot) const { return slot >= 0 && slot < m_designationColors.size(); }
+
+private:
+    QVector<QColor> m_designationColors;
+    QVector<QColor> m_typeColors;
+    bool m_showTypes = false;
+};
+
+// Отрезок провода, цвет пера которого берётся из палитры в момент отрисовки.
+// Временная подсветка (выделение, состояние симуляции) задаётся цветом поверх палитры.
+// Границы и контур кэшируются до смены линии или ширины пера; попадание в отрезок
+// с круглыми концами проверяется аналитически, без построения обводки.
+class WireItem : public QGraphicsLineItem {
+public:
+    WireItem(const QLineF& line, const QPen& pen, const NetPalette* palette);
+
+    void setPaletteSlot(int slot) { m_slot = slot; }
+    int paletteSlot() const { return m_slot; }
+
+    void setOverrideColor(const QColor& color);
+    void clearOverrideColor();
+    QColor color() const;
+
+    QRectF boundingRect() const override;
+    QPainterPath shape() const override;
+    bool contains(const QPointF& point) const override;
+    bool collidesWithPath(const QPainterPath& path, Qt::ItemSelectionMode mode = Qt::IntersectsItemShape) const override;
+
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+private:
+    void validateGeometry() const;
+    qreal radius() const;
+    bool intersectsRect(const QRectF& rect) const;
+    static bool isRectPath(const QPainterPath& path, const QRectF& rect);
+    static qreal distanceToSegment(const QPointF& point, const QLineF& segment);
+
+    const NetPalette* m_palette;
+    int m_slot = -1;
+    QColor m_overrideColor;
+
+    mutable QLineF m_cachedLine;
+    mutable qreal m_cachedWidth = -1;
+    mutable QRectF m_boundingRect;
+    mutable QPainterPath m_shape;
+    mutable bool m_shapeValid = false;
+};
+
+#endif // WIREITEM_H